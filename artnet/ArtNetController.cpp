@@ -1,9 +1,13 @@
 #include "ArtNetController.h"
 #include "artnet_types.h"
 #include "logging.h"
+#include "packet_view.h"
 #include "utils.h"
 
+#include <algorithm>
+#include <arpa/inet.h>
 #include <chrono>
+#include <cstddef>
 #include <cstring>
 #include <iomanip>
 #include <random>
@@ -13,15 +17,20 @@
 #ifdef __APPLE__
 #include "network_interface_bsd.h"
 #else
+#include "network_interface_io_uring.h"
 #include "network_interface_linux.h"
 #endif
 
 namespace ArtNet
 {
 
+// Receive worker running on this thread, it picks the producer side of the
+// callback dispatch rings
+static thread_local size_t t_receiveWorker = 0;
+
 ArtNetController::ArtNetController() :
-		m_port(ARTNET_PORT), m_net(0), m_subnet(0), m_universe(0), m_isRunning(
-				false), m_seqNumber(0), m_dataCallback(nullptr), m_isConfigured(
+		m_port(ARTNET_PORT), m_net(0), m_subnet(0), m_universe(0), m_portAddress(
+				0), m_isRunning(false), m_dataCallback(nullptr), m_isConfigured(
 				false), m_frameInterval(
 				std::chrono::microseconds(1000000 / ARTNET_FPS))
 {
@@ -47,16 +56,30 @@ bool ArtNetController::configure(const std::string &bindAddress, int port,
 			static_cast<int>(subnet), " universe=", static_cast<int>(universe),
 			" broadcast=", broadcastAddress);
 
+	std::string broadcast =
+			broadcastAddress.empty() ? "255.255.255.255" : broadcastAddress;
+	if (!Endpoint::parse(broadcast, port, m_broadcastEndpoint))
+	{
+		Logger::error("Invalid broadcast address: ", broadcast);
+		return false;
+	}
+
 	// Store configuration
 	m_bindAddress = bindAddress;
 	m_port = port;
 	m_net = net;
 	m_subnet = subnet;
 	m_universe = universe;
-	m_broadcastAddress =
-			broadcastAddress.empty() ? "255.255.255.255" : broadcastAddress;
+	m_portAddress = makePortAddress(net, subnet, universe);
+	m_broadcastAddress = broadcast;
 	m_isConfigured = true;
 
+	{
+		std::unique_lock<std::shared_mutex> lock(m_subscriptionMutex);
+		m_subscriptions.clear();
+		m_subscriptions.add(m_portAddress);
+	}
+
 	Logger::info("Controller configured successfully");
 
 	return true;
@@ -67,6 +90,200 @@ void ArtNetController::setEnableSendingDMX(bool enable)
 	m_enableSendingDMX = enable;
 }
 
+void ArtNetController::setTransmitMode(TransmitMode mode)
+{
+	m_transmitMode = mode;
+}
+
+void ArtNetController::setEnableSyncOutput(bool enable)
+{
+	m_enableSyncOutput = enable;
+}
+
+void ArtNetController::setEnableTrimmedDmx(bool enable)
+{
+	m_enableTrimmedDmx = enable;
+}
+
+void ArtNetController::setEnableDiscovery(bool enable)
+{
+	m_enableDiscovery = enable;
+	if (m_isRunning && !m_workers.empty())
+	{
+		m_workers[0]->loop.armTimer(m_pollTimer,
+				enable ? POLL_INTERVAL : std::chrono::nanoseconds(0));
+	}
+}
+
+void ArtNetController::setMaxUnicastNodes(size_t count)
+{
+	std::lock_guard<std::mutex> lock(m_nodesMutex);
+	m_maxUnicastNodes = count;
+}
+
+bool ArtNetController::setRefreshInterval(std::chrono::milliseconds interval)
+{
+	if (interval < MIN_REFRESH_INTERVAL || interval > MAX_REFRESH_INTERVAL)
+	{
+		Logger::error("Refresh interval must be between ",
+				MIN_REFRESH_INTERVAL.count(), " and ",
+				MAX_REFRESH_INTERVAL.count(), " ms");
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_dataMutex);
+	m_refreshInterval = interval;
+	return true;
+}
+
+bool ArtNetController::setFrameScheduler(FrameScheduler::Strategy strategy,
+		FrameScheduler::OverrunPolicy policy)
+{
+	if (m_isRunning)
+	{
+		Logger::error("Frame scheduler can only be changed while stopped");
+		return false;
+	}
+
+	m_scheduler.setStrategy(strategy);
+	m_scheduler.setOverrunPolicy(policy);
+	return true;
+}
+
+bool ArtNetController::setPacketPacing(double fraction)
+{
+	if (fraction < 0 || fraction > 1)
+	{
+		Logger::error("Pacing fraction must be between 0 and 1");
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_dataMutex);
+	m_pacingFraction = fraction;
+	updatePacerWindow();
+	return true;
+}
+
+void ArtNetController::setMaxByteRate(uint64_t bytesPerSecond)
+{
+	std::lock_guard<std::mutex> lock(m_dataMutex);
+	m_maxByteRate = bytesPerSecond;
+	{
+		std::lock_guard<std::mutex> pacerLock(m_pacerMutex);
+		m_pacer.setByteRate(bytesPerSecond);
+	}
+	if (m_isRunning && m_networkInterface)
+	{
+		m_networkInterface->setMaxPacingRate(bytesPerSecond);
+	}
+}
+
+bool ArtNetController::setReceiveWorkers(size_t count)
+{
+	if (m_isRunning)
+	{
+		Logger::error("Receive workers can only be changed while stopped");
+		return false;
+	}
+	if (count == 0 || count > MAX_RECEIVE_WORKERS)
+	{
+		Logger::error("Receive workers must be between 1 and ",
+				MAX_RECEIVE_WORKERS);
+		return false;
+	}
+
+	m_receiveWorkers = count;
+	return true;
+}
+
+bool ArtNetController::setCallbackDispatch(size_t workers,
+		CallbackDispatcher::Policy policy, size_t ringCapacity)
+{
+	if (m_isRunning)
+	{
+		Logger::error("Callback dispatch can only be changed while stopped");
+		return false;
+	}
+	if (workers > CallbackDispatcher::MAX_WORKERS || ringCapacity == 0)
+	{
+		Logger::error("Dispatch workers must be between 0 and ",
+				CallbackDispatcher::MAX_WORKERS, " with a non-empty ring");
+		return false;
+	}
+
+	m_dispatchWorkers = workers;
+	m_dispatchPolicy = policy;
+	m_dispatchRingSize = ringCapacity;
+	return true;
+}
+
+std::vector<CallbackDispatcher::RingStatistics> ArtNetController::getDispatchStatistics() const
+{
+	return m_dispatcher.getStatistics();
+}
+
+bool ArtNetController::setEnableKernelTimestamps(bool enable)
+{
+	if (m_isRunning)
+	{
+		Logger::error("Kernel timestamps can only be changed while stopped");
+		return false;
+	}
+
+	m_kernelTimestamps = enable;
+	return true;
+}
+
+bool ArtNetController::setReceivePoolSize(size_t slots)
+{
+	if (m_isRunning)
+	{
+		Logger::error("Receive pool can only be resized while stopped");
+		return false;
+	}
+	if (slots != 0 && slots < m_receiveWorkers * RECEIVE_BATCH_SIZE)
+	{
+		Logger::error("Receive pool needs at least ",
+				m_receiveWorkers * RECEIVE_BATCH_SIZE, " slots");
+		return false;
+	}
+
+	m_packetPoolSize = slots;
+	return true;
+}
+
+bool ArtNetController::setNetworkBackend(NetworkBackend backend)
+{
+	if (m_isRunning)
+	{
+		Logger::error("Network backend can only be changed while stopped");
+		return false;
+	}
+
+	m_networkBackend = backend;
+	return true;
+}
+
+NetworkBackend ArtNetController::getNetworkBackend() const
+{
+	if (m_isRunning && m_networkInterface)
+		return m_networkInterface->getBackend();
+	return m_networkBackend;
+}
+
+std::unique_ptr<NetworkInterface> ArtNetController::createNetworkInterface(
+		NetworkBackend backend)
+{
+#ifdef __APPLE__
+	(void) backend;
+	return std::make_unique<NetworkInterfaceBSD>();
+#else
+	if (backend == NetworkBackend::IoUring)
+		return std::make_unique<NetworkInterfaceIoUring>();
+	return std::make_unique<NetworkInterfaceLinux>();
+#endif
+}
+
 bool ArtNetController::start()
 {
 	if (!m_isConfigured)
@@ -80,11 +297,8 @@ bool ArtNetController::start()
 		return false;
 	}
 
-#ifdef __APPLE__
-  m_networkInterface = std::make_unique<NetworkInterfaceBSD>();
-#else
-	m_networkInterface = std::make_unique<NetworkInterfaceLinux>();
-#endif
+	m_networkInterface = createNetworkInterface(m_networkBackend);
+	m_networkInterface->setReusePort(m_receiveWorkers > 1);
 
 	if (!m_networkInterface->createSocket(m_bindAddress, m_port))
 	{
@@ -96,9 +310,119 @@ bool ArtNetController::start()
 		return false;
 	}
 
+	m_localAddresses = utils::localIPv4Addresses();
+
+	// Kernel pacing smooths the wire on top of the user-space token bucket
+	if (m_maxByteRate > 0)
+	{
+		m_networkInterface->setMaxPacingRate(m_maxByteRate);
+	}
+
+	// Extra receive sockets join the port's SO_REUSEPORT group in worker
+	// order, which is the index the kernel filter returns
+	m_receiveInterfaces.clear();
+	for (size_t worker = 1; worker < m_receiveWorkers; worker++)
+	{
+		std::unique_ptr<NetworkInterface> receiveInterface =
+				createNetworkInterface(m_networkBackend);
+		receiveInterface->setReusePort(true);
+		if (!receiveInterface->createSocket(m_bindAddress, m_port)
+				|| !receiveInterface->bindSocket())
+		{
+			Logger::error("Failed to open socket for receive worker ", worker);
+			receiveInterface->closeSocket();
+			for (auto &opened : m_receiveInterfaces)
+			{
+				opened->closeSocket();
+			}
+			m_receiveInterfaces.clear();
+			m_networkInterface->closeSocket();
+			return false;
+		}
+		m_receiveInterfaces.push_back(std::move(receiveInterface));
+	}
+
+	if (m_kernelTimestamps)
+	{
+		// Histograms exist before any worker records into them
+		{
+			std::unique_lock<std::shared_mutex> lock(m_subscriptionMutex);
+			for (uint16_t universe : m_subscriptions.addresses())
+			{
+				Subscription &subscription = m_subscriptions.at(universe);
+				if (!subscription.queueDelay)
+				{
+					subscription.queueDelay =
+							std::make_unique<LatencyHistogram>();
+				}
+			}
+		}
+
+		bool enabled = m_networkInterface->setKernelTimestamps(true);
+		for (auto &receiveInterface : m_receiveInterfaces)
+		{
+			enabled = receiveInterface->setKernelTimestamps(true) && enabled;
+		}
+		if (!enabled)
+		{
+			Logger::info("Kernel timestamps unavailable on this platform");
+		}
+	}
+
+	// Without the kernel filter the group hashes unicast datagrams to any
+	// socket, where the shard check would drop most of them
+	m_activeReceiveWorkers = m_receiveWorkers;
+	if (m_receiveWorkers > 1
+			&& !m_networkInterface->attachReceiveSharding(m_receiveWorkers))
+	{
+		Logger::info("Kernel receive sharding unavailable, receiving on one ",
+				"worker");
+		for (auto &receiveInterface : m_receiveInterfaces)
+		{
+			receiveInterface->closeSocket();
+		}
+		m_receiveInterfaces.clear();
+		m_activeReceiveWorkers = 1;
+	}
+
+	// Packets still held from the last run keep their slots when the size
+	// is unchanged
+	size_t poolSize =
+			m_packetPoolSize > 0 ?
+					m_packetPoolSize :
+					2 * m_activeReceiveWorkers * RECEIVE_BATCH_SIZE;
+	poolSize = std::max(poolSize, m_activeReceiveWorkers * RECEIVE_BATCH_SIZE);
+	if (m_packetPool.getStatistics().capacity != poolSize
+			&& !m_packetPool.allocate(poolSize))
+	{
+		m_networkInterface->closeSocket();
+		for (auto &receiveInterface : m_receiveInterfaces)
+		{
+			receiveInterface->closeSocket();
+		}
+		return false;
+	}
+
 	m_isRunning = true;
 
-	m_receiveThread = std::thread(&ArtNetController::receivePackets, this);
+	// Consumers first, receive workers push as soon as they run
+	if (m_dispatchWorkers > 0
+			&& !m_dispatcher.start(m_activeReceiveWorkers, m_dispatchWorkers,
+					m_dispatchRingSize,
+					[this](const CallbackDispatcher::Item &item)
+					{
+						runDispatched(item);
+					}))
+	{
+		stop();
+		return false;
+	}
+
+	if (!startWorkers())
+	{
+		stop();
+		return false;
+	}
 
 	return true;
 }
@@ -115,8 +439,104 @@ bool ArtNetController::start(FrameGenerator generator, int fps)
 	return true;
 }
 
+bool ArtNetController::start(FrameRenderer renderer,
+		const std::vector<uint16_t> &universes, int fps)
+{
+	for (uint16_t universe : universes)
+	{
+		if (universe >= ARTNET_PORT_ADDRESS_COUNT)
+		{
+			Logger::error("Universe out of range: ", universe);
+			return false;
+		}
+	}
+
+	if (!start())
+		return false;
+
+	// Views point straight into the packet templates, which stay put once
+	// allocated, so the renderer writes where the packets are sent from
+	{
+		std::lock_guard<std::mutex> lock(m_dataMutex);
+		m_renderFrames.clear();
+		for (uint16_t universe : universes)
+		{
+			UniverseState &state = m_universes.acquire(universe);
+			if (state.length == 0)
+				state.length = ARTNET_MAX_DMX_SIZE;
+			m_renderFrames.push_back(UniverseFrame
+			{ universe, state.data(), state.length });
+		}
+		m_renderDirty.assign(m_renderFrames.size(), false);
+	}
+
+	m_frameRenderer = std::move(renderer);
+	m_frameInterval = std::chrono::microseconds(1000000 / fps);
+	startFrameProcessor();
+	return true;
+}
+
+bool ArtNetController::submitFrame(const uint8_t *data, size_t length)
+{
+	if (length == 0 || length > ARTNET_MAX_DMX_SIZE)
+	{
+		Logger::error("Invalid DMX length: ", length);
+		return false;
+	}
+
+	DmxFrame &frame = m_frameBuffer.writeBuffer();
+	std::memcpy(frame.data.data(), data, length);
+	frame.length = static_cast<uint16_t>(length);
+	if (!m_frameBuffer.publish())
+	{
+		m_stats.droppedFrames++;
+	}
+	return true;
+}
+
+bool ArtNetController::renderFrame()
+{
+	// Rendering happens under the data lock since the views alias the
+	// packets that sendDmx() may be sending from another thread
+	std::lock_guard<std::mutex> lock(m_dataMutex);
+
+	std::fill(m_renderDirty.begin(), m_renderDirty.end(), false);
+	m_frameRenderer(m_renderFrames.data(), m_renderFrames.size(), m_renderDirty);
+
+	bool changed = false;
+	for (size_t i = 0; i < m_renderFrames.size(); i++)
+	{
+		if (!m_renderDirty[i])
+			continue;
+
+		UniverseFrame &frame = m_renderFrames[i];
+		if (frame.length == 0 || frame.length > ARTNET_MAX_DMX_SIZE)
+		{
+			frame.length = ARTNET_MAX_DMX_SIZE;
+		}
+		UniverseState &state = *m_universes.find(frame.universe);
+		state.length = frame.length;
+		state.pending = true;
+		changed = true;
+	}
+	return changed;
+}
+
 void ArtNetController::startFrameProcessor()
 {
+	{
+		std::lock_guard<std::mutex> lock(m_dataMutex);
+		updatePacerWindow();
+	}
+
+	// Every frame refreshes stale universes, the timer is not needed
+	m_keepAliveScheduled = true;
+	if (!m_workers.empty())
+	{
+		m_workers[0]->loop.armTimer(m_keepAliveTimer,
+				std::chrono::nanoseconds(0));
+	}
+
 	m_processorThread =
 			std::thread([this]() 
 			{
@@ -126,7 +546,7 @@ void ArtNetController::startFrameProcessor()
 						Logger::info("Failed to set high priority for frame processor thread. Try running with sudo or setting capability.");
 					}
 
-					auto nextFrame = std::chrono::steady_clock::now();
+					m_scheduler.start(m_frameInterval);
 
 					while (m_isRunning)
 					{
@@ -138,17 +558,9 @@ void ArtNetController::startFrameProcessor()
 							try
 							{
 								auto dmxData = m_frameGenerator();
-
-								// Lock only for queue operations
+								if (!dmxData.empty())
 								{
-									std::lock_guard<std::mutex> lock(m_queueMutex);
-									if (m_frameQueue.size() >= MAX_QUEUE_SIZE)
-									{
-										m_stats.droppedFrames++;
-										m_frameQueue.pop();
-									}
-									m_frameQueue.push(std::move(dmxData));
-									m_stats.queueDepth = m_frameQueue.size();
+									submitFrame(dmxData.data(), dmxData.size());
 								}
 							}
 							catch (const std::exception &e)
@@ -157,26 +569,31 @@ void ArtNetController::startFrameProcessor()
 							}
 						}
 
-						// Process queue
-						std::vector<uint8_t> frame;
+						bool newFrame = false;
+						if (m_frameRenderer)
 						{
-							std::lock_guard<std::mutex> lock(m_queueMutex);
-							if (!m_frameQueue.empty())
+							try
 							{
-								frame = std::move(m_frameQueue.front());
-								m_frameQueue.pop();
-								m_stats.queueDepth = m_frameQueue.size();
+								newFrame = renderFrame();
+							}
+							catch (const std::exception &e)
+							{
+								Logger::error("Frame renderer error: ", e.what());
 							}
 						}
 
-						// Send frame if available
-						if (!frame.empty())
+						// Take the newest complete frame, older ones were overwritten
+						if (m_frameBuffer.update())
 						{
-							setDmxData(m_universe, frame);
-							if (sendDmx())
-							{
-								m_stats.totalFrames++;
-							}
+							const DmxFrame &frame = m_frameBuffer.readBuffer();
+							setDmxData(m_portAddress, frame.data.data(), frame.length);
+							newFrame = true;
+						}
+
+						// Also flushes keep-alives when no new frame arrived
+						if (flushDmx() && newFrame)
+						{
+							m_stats.totalFrames++;
 						}
 
 						// Calculate timing for next frame
@@ -184,12 +601,9 @@ void ArtNetController::startFrameProcessor()
 						m_stats.lastFrameTime = std::chrono::duration_cast<std::chrono::microseconds>(frameEnd - frameStart);
 
 						// Sleep until next frame
-						nextFrame += m_frameInterval;
-						if (frameEnd < nextFrame)
-						{
-							std::this_thread::sleep_until(nextFrame);
-						}
+						m_scheduler.waitNextFrame();
 					}
+					m_scheduler.stop();
 				});
 
 	// Optionally set CPU affinity to bind the thread to a specific core
@@ -210,26 +624,20 @@ void ArtNetController::stop()
 	{
 		m_processorThread.join();
 	}
+	m_frameGenerator = nullptr;
+	m_frameRenderer = nullptr;
 
-	// Gracefully shut down the socket for receiving data
-	if (m_networkInterface)
-	{
-		if (m_networkInterface->getSocket() != -1)
-		{
-			shutdown(m_networkInterface->getSocket(), SHUT_RD); // Shutdown receive operations
-		}
-	}
-
-	// Stop receive thread
-	if (m_receiveThread.joinable())
-	{
-		m_receiveThread.join();
-	}
+	stopWorkers();
+	m_dispatcher.stop();
 
 	if (m_networkInterface)
 	{
 		m_networkInterface->closeSocket();
 	}
+	for (auto &receiveInterface : m_receiveInterfaces)
+	{
+		receiveInterface->closeSocket();
+	}
 }
 
 bool ArtNetController::isRunning() const
@@ -271,16 +679,10 @@ bool ArtNetController::setDmxData(uint16_t universe,
 		Logger::error("DMX data exceeds max size");
 		return false;
 	}
-	if (universe != m_universe)
-	{
-		return false;
-	}
 
 	logDmxData(data);
 
-	std::lock_guard<std::mutex> lock(m_dataMutex);
-	m_dmxData = data;
-	return true;
+	return setDmxData(universe, data.data(), data.size());
 }
 
 bool ArtNetController::setDmxData(uint16_t universe, const uint8_t *data,
@@ -291,65 +693,360 @@ bool ArtNetController::setDmxData(uint16_t universe, const uint8_t *data,
 		std::cerr << "ArtNet: DMX data exceeds max size" << std::endl;
 		return false;
 	}
-	if (universe != m_universe)
+	if (universe >= ARTNET_PORT_ADDRESS_COUNT)
 	{
+		Logger::error("Universe out of range: ", universe);
 		return false;
 	}
 
 	std::lock_guard<std::mutex> lock(m_dataMutex);
-	m_dmxData.assign(data, data + length);
-	return true;
-}
+	UniverseState &state = m_universes.acquire(universe);
 
-std::vector<uint8_t> ArtNetController::getDmxData(uint16_t universe)
+	// memcmp is vectorized by the C library, cheaper than a resend
+	if (m_transmitMode == TransmitMode::OnChange && state.length == length
+			&& std::memcmp(state.data(), data, length) == 0)
+	{
+		m_stats.unchangedUpdates++;
+		return true;
+	}
+
+	std::memcpy(state.data(), data, length);
+	state.length = static_cast<uint16_t>(length);
+	state.pending = true;
+	return true;
+}
+
+std::vector<uint8_t> ArtNetController::getDmxData(uint16_t universe)
 {
 	std::lock_guard<std::mutex> lock(m_dataMutex);
-	if (universe == m_universe)
-		return m_dmxData;
+	const UniverseState *state = m_universes.find(universe);
+	if (state)
+		return std::vector<uint8_t>(state->data(),
+				state->data() + state->length);
 	else
 		return std::vector<uint8_t>();
 }
 
 bool ArtNetController::sendDmx()
+{
+	return transmitUniverses(Selection::All);
+}
+
+bool ArtNetController::flushDmx()
+{
+	return transmitUniverses(Selection::Updated);
+}
+
+bool ArtNetController::sendDmx(uint16_t universe)
 {
 	if (!m_enableSendingDMX)
 		return true; // Do nothing if sending is disabled
 
-	std::vector<uint8_t> packet;
+	if (!m_isRunning || !m_networkInterface)
+	{
+		Logger::error("Not Running or Interface not initialized");
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(m_dataMutex);
+	UniverseState *state = m_universes.find(universe);
+	if (!state || state->length == 0)
+		return false;
 
 	{
-		std::lock_guard<std::mutex> lock(m_dataMutex);
-		if (m_dmxData.empty())
-			return false;
+		std::lock_guard<std::mutex> nodesLock(m_nodesMutex);
+		queueUniverse(universe, *state);
+	}
+	state->lastSent = std::chrono::steady_clock::now();
 
-		if (!prepareArtDmxPacket(m_universe, m_dmxData.data(), m_dmxData.size(),
-				packet))
-			return false;
+	queueSync();
+	return sendQueued(lock);
+}
+
+bool ArtNetController::sendDmx(uint16_t universe, const uint8_t *data,
+		size_t length)
+{
+	if (!m_enableSendingDMX)
+		return true; // Do nothing if sending is disabled
+
+	if (length == 0 || length > ARTNET_MAX_DMX_SIZE)
+	{
+		Logger::error("Invalid DMX length: ", length);
+		return false;
+	}
+	if (universe >= ARTNET_PORT_ADDRESS_COUNT)
+	{
+		Logger::error("Universe out of range: ", universe);
+		return false;
+	}
+	if (!m_isRunning || !m_networkInterface)
+	{
+		Logger::error("Not Running or Interface not initialized");
+		return false;
+	}
+
+	// The header is shared with the stored packet so the sequence stays
+	// continuous; the lock is held until the datagram has left or, when
+	// paced, has been copied
+	std::unique_lock<std::mutex> lock(m_dataMutex);
+	UniverseState &state = m_universes.acquire(universe);
+	uint16_t wireLength = state.wireLength(data,
+			static_cast<uint16_t>(length), m_enableTrimmedDmx);
+	state.stampHeader(wireLength);
+	m_stats.trimmedBytes += length - wireLength;
+
+	{
+		std::lock_guard<std::mutex> nodesLock(m_nodesMutex);
+		queueRouted(universe, OutgoingPacket
+		{ state.packet.data(), ARTDMX_HEADER_SIZE, data, wireLength,
+				m_broadcastEndpoint });
 	}
 
-	return sendPacket(packet);
+	queueSync();
+	return sendQueued(lock);
 }
 
-// bool ArtNetController::sendPoll() {
-//   std::vector<uint8_t> packet;
-//
-//   if (!prepareArtPollPacket(packet)) {
-//     Logger::info("sendPoll: prepareArtDmxPacket false");
-//     return false;
-//   }
-//
-//   return sendPacket(packet);
-// }
+bool ArtNetController::transmitUniverses(Selection selection)
+{
+	if (!m_enableSendingDMX)
+		return true; // Do nothing if sending is disabled
+
+	if (!m_isRunning || !m_networkInterface)
+	{
+		Logger::error("Not Running or Interface not initialized");
+		return false;
+	}
+
+	// Packets are sent straight from the universe templates, so the lock is
+	// held until the batch is on the wire, or copied when it is paced
+	std::unique_lock<std::mutex> lock(m_dataMutex);
+
+	auto now = std::chrono::steady_clock::now();
+	uint64_t keepAlives = 0;
+	size_t queued = 0;
+
+	{
+		std::lock_guard<std::mutex> nodesLock(m_nodesMutex);
+
+		for (uint16_t universe : m_universes.active())
+		{
+			UniverseState &state = *m_universes.find(universe);
+			if (state.length == 0)
+				continue;
+
+			// Unchanged universes still have to be refreshed periodically
+			if (selection == Selection::All
+					|| (selection == Selection::Updated && state.pending))
+			{
+			}
+			else if (now - state.lastSent >= m_refreshInterval)
+			{
+				keepAlives++;
+			}
+			else
+			{
+				continue;
+			}
+
+			queueUniverse(universe, state);
+			state.lastSent = now;
+			queued++;
+		}
+	}
+	m_stats.keepAlivePackets += keepAlives;
+
+	if (queued == 0)
+		return selection != Selection::All; // sendDmx() with no data is an error
+
+	// Without a frame processor the event loop refreshes what was sent
+	if (!m_workers.empty() && !m_keepAliveScheduled.exchange(true))
+	{
+		m_workers[0]->loop.armTimer(m_keepAliveTimer,
+				KEEP_ALIVE_CHECK_INTERVAL);
+	}
+
+	queueSync();
+	// Keep-alives run on receive worker 0's loop and are a few packets with
+	// no frame to spread, so they never wait for the pacer
+	return sendQueued(lock, selection != Selection::KeepAlivesOnly);
+}
+
+void ArtNetController::queueSync()
+{
+	// ArtSync closes the batch, it is always broadcast
+	if (m_enableSyncOutput)
+	{
+		m_txBatch.push_back(OutgoingPacket
+		{ reinterpret_cast<const uint8_t*>(&m_syncPacket),
+				sizeof(m_syncPacket), m_broadcastEndpoint });
+		m_stats.syncPacketsSent++;
+	}
+}
+
+void ArtNetController::queueUniverse(uint16_t universe, UniverseState &state)
+{
+	size_t size = state.stampPacket(m_enableTrimmedDmx);
+	m_stats.trimmedBytes += ARTDMX_HEADER_SIZE + state.length - size;
+	queueRouted(universe, OutgoingPacket
+	{ state.packet.data(), size, m_broadcastEndpoint });
+	state.pending = false;
+}
+
+void ArtNetController::queueRouted(uint16_t universe, OutgoingPacket packet)
+{
+	// Unicast to the subscribed nodes, broadcast when nobody or too many
+	// nodes subscribed
+	auto route = m_routes.find(universe);
+	if (route == m_routes.end() || route->second.size() > m_maxUnicastNodes)
+	{
+		m_txBatch.push_back(packet);
+		return;
+	}
+
+	for (const Endpoint &endpoint : route->second)
+	{
+		packet.destination = endpoint;
+		m_txBatch.push_back(packet);
+	}
+}
+
+bool ArtNetController::sendQueued(std::unique_lock<std::mutex> &dataLock,
+		bool paced)
+{
+	size_t queued = m_txBatch.size();
+	size_t sent;
+
+	// Same condition as PacketPacer::isEnabled(), without its lock
+	if (!paced || (m_pacingFraction <= 0 && m_maxByteRate == 0))
+	{
+		sent = m_networkInterface->sendPackets(m_txBatch.data(), queued);
+		m_txBatch.clear();
+	}
+	else
+	{
+		// Pacing sleeps for up to the pacing window, so the batch leaves
+		// from a copy and universe data is unlocked meanwhile. Each sending
+		// thread keeps its own copy, which only ever grows.
+		static thread_local std::vector<uint8_t> t_pacedData;
+		static thread_local std::vector<OutgoingPacket> t_pacedBatch;
+
+		size_t bytes = 0;
+		for (const OutgoingPacket &packet : m_txBatch)
+		{
+			for (size_t i = 0; i < packet.segmentCount; i++)
+				bytes += packet.segments[i].iov_len;
+		}
+		if (t_pacedData.size() < bytes)
+			t_pacedData.resize(bytes);
+
+		t_pacedBatch.clear();
+		uint8_t *copy = t_pacedData.data();
+		for (const OutgoingPacket &packet : m_txBatch)
+		{
+			size_t size = 0;
+			for (size_t i = 0; i < packet.segmentCount; i++)
+			{
+				std::memcpy(copy + size, packet.segments[i].iov_base,
+						packet.segments[i].iov_len);
+				size += packet.segments[i].iov_len;
+			}
+			t_pacedBatch.push_back(OutgoingPacket
+			{ copy, size, packet.destination });
+			copy += size;
+		}
+		m_txBatch.clear();
+		dataLock.unlock();
+
+		std::lock_guard<std::mutex> pacerLock(m_pacerMutex);
+		sent = m_pacer.send(*m_networkInterface, t_pacedBatch.data(),
+				t_pacedBatch.size());
+	}
+
+	if (sent != queued)
+	{
+		Logger::error("Error sending DMX batch, sent ", sent, " of ", queued);
+		return false;
+	}
+	return true;
+}
+
+void ArtNetController::updatePacerWindow()
+{
+	std::lock_guard<std::mutex> pacerLock(m_pacerMutex);
+	m_pacer.setWindow(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			m_frameInterval * m_pacingFraction));
+}
+
+ArtNetController::Statistics::Snapshot ArtNetController::getStatistics() const
+{
+	Statistics::Snapshot snapshot = m_stats.getSnapshot();
+	snapshot.queueDepth = m_frameBuffer.pending() ? 1 : 0;
+	snapshot.scheduler = m_scheduler.getStatistics();
+	snapshot.pacing = m_pacer.getStatistics();
+	snapshot.receivePool = m_packetPool.getStatistics();
+	if (m_networkInterface)
+	{
+		NetworkInterface::SendStatistics sendStats =
+				m_networkInterface->getSendStatistics();
+		snapshot.packetsSent = sendStats.packetsSent;
+		snapshot.sendSyscalls = sendStats.sendCalls;
+		snapshot.sendDelay = m_networkInterface->getSendDelay();
+
+		NetworkInterface::ReceiveStatistics receiveStats =
+				m_networkInterface->getReceiveStatistics();
+		snapshot.packetsReceived = receiveStats.packetsReceived;
+		snapshot.receiveSyscalls = receiveStats.receiveCalls;
+		snapshot.largestReceiveBatch = receiveStats.largestBatch;
+	}
+	for (const auto &receiveInterface : m_receiveInterfaces)
+	{
+		NetworkInterface::ReceiveStatistics receiveStats =
+				receiveInterface->getReceiveStatistics();
+		snapshot.packetsReceived += receiveStats.packetsReceived;
+		snapshot.receiveSyscalls += receiveStats.receiveCalls;
+		snapshot.largestReceiveBatch = std::max(snapshot.largestReceiveBatch,
+				receiveStats.largestBatch);
+	}
+	return snapshot;
+}
+
+bool ArtNetController::sendPoll()
+{
+	// Forget nodes that stopped answering before asking again
+	{
+		std::lock_guard<std::mutex> lock(m_nodesMutex);
+		auto now = std::chrono::steady_clock::now();
+		size_t before = m_discoveredNodes.size();
+
+		for (auto it = m_discoveredNodes.begin(); it != m_discoveredNodes.end();)
+		{
+			if (now - it->second.lastSeen > NODE_TIMEOUT)
+			{
+				Logger::info("Node timed out: ", it->first);
+				it = m_discoveredNodes.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+
+		if (m_discoveredNodes.size() != before)
+			rebuildRoutes();
+	}
+
+	ArtPollPacket pollPacket;
+	pollPacket.flags = 0x02; // Send ArtPollReply whenever node conditions change
+
+	return sendPacket(reinterpret_cast<const uint8_t*>(&pollPacket),
+			sizeof(pollPacket));
+}
 
 void ArtNetController::sendPollReply(const uint8_t *buffer,
 		sockaddr_in senderAddr)
 {
 	// Use senderAddr to reply in unicast
-	std::string destIP = utils::formatIP(
-			reinterpret_cast<const uint8_t*>(&senderAddr.sin_addr.s_addr), 4);
-	int destPort = ntohs(senderAddr.sin_port);
-
-	Logger::debug("--> sendPollReply start...", destIP, " Port: ", destPort);
+	Endpoint destination(senderAddr);
 
 	// Create the ArtPollReply packet
 	ArtPollReplyPacket replyPacket;
@@ -422,8 +1119,12 @@ void ArtNetController::sendPollReply(const uint8_t *buffer,
 	// 18. GoodInputA (Example: No input, all bits cleared)
 	replyPacket.goodInputA.fill(0x08);
 
-	// 19. GoodOutputA (Example: DMX outputting, merging not active, not LTP)
+	// 19. GoodOutputA (DMX outputting, merge state of the output universe)
 	replyPacket.goodOutputA[0] = 0x80; // DMX Outputting
+	if (m_outputMerging)
+		replyPacket.goodOutputA[0] |= 0x08; // Merging Art-Net data
+	if (m_mergeMode == DmxMerger::Mode::LTP)
+		replyPacket.goodOutputA[0] |= 0x02; // Merge mode is LTP
 	replyPacket.goodOutputA[1] = 0x00;
 	replyPacket.goodOutputA[2] = 0x00;
 	replyPacket.goodOutputA[3] = 0x00;
@@ -431,17 +1132,18 @@ void ArtNetController::sendPollReply(const uint8_t *buffer,
 	// 20. SwIn (Example: All set to universe 0)
 	replyPacket.swIn.fill(0);
 
-	// 21. SwOut (Example: All set to universe 0)
+	// 21. SwOut (Port 0 outputs the configured universe)
 	replyPacket.swOut.fill(0);
+	replyPacket.swOut[0] = m_universe & 0x0F;
 
 	// 22. AcnPriority (Example: sACN Priority 100)
-	replyPacket.acnPriority.fill(100);
+	replyPacket.acnPriority = 100;
 
 	// 23. SwMacro (Example: No macros active)
-	replyPacket.swMacro.fill(0);
+	replyPacket.swMacro = 0;
 
 	// 24. SwRemote (Example: No remote triggers active)
-	replyPacket.swRemote.fill(0);
+	replyPacket.swRemote = 0;
 
 	// 25. Style (Example: StNode)
 	replyPacket.style = 0x00; // StNode
@@ -493,10 +1195,6 @@ void ArtNetController::sendPollReply(const uint8_t *buffer,
 	// Calculate packet size
 	size_t packetSize = sizeof(ArtPollReplyPacket);
 
-	// Resize packet and copy data
-	std::vector<uint8_t> packet(packetSize);
-	std::memcpy(packet.data(), &replyPacket, packetSize);
-
 	// Debug print replyPacket bytes
 	// Logger::debug("ArtPollReply packet bytes:");
 	// for (size_t i = 0; i < sizeof(replyPacket); i++) {
@@ -515,69 +1213,231 @@ void ArtNetController::sendPollReply(const uint8_t *buffer,
 	// }
 	// std::cout << std::endl;
 
-	// Send the packet
-	sendPacket(packet, destIP, destPort);
+	// Send the packet straight from the struct
+	sendPacket(reinterpret_cast<const uint8_t*>(&replyPacket), packetSize,
+			destination);
 
-	Logger::info("--> Sent ArtPollReply to: ", destIP, ":", destPort);
+	if (Logger::getLevel() >= LogLevel::INFO)
+	{
+		Logger::info("--> Sent ArtPollReply to: ",
+				utils::ipAddressToString(senderAddr), ":", destination.port());
+	}
 }
 
-void ArtNetController::registerDataCallback(DataCallback callback)
+bool ArtNetController::subscribe(uint16_t first, uint16_t last,
+		DataCallback callback, bool buffered)
 {
-	std::lock_guard<std::mutex> lock(m_dataMutex);
+	if (first > last || last >= ARTNET_PORT_ADDRESS_COUNT)
+	{
+		Logger::error("Invalid Port-Address range: ", first, "..", last);
+		return false;
+	}
 
-	m_dataCallback = callback;
+	std::unique_lock<std::shared_mutex> lock(m_subscriptionMutex);
+	for (uint32_t universe = first; universe <= last; universe++)
+	{
+		Subscription &subscription = m_subscriptions.add(
+				static_cast<uint16_t>(universe));
+		subscription.callback = callback;
+		subscription.buffered = buffered;
+		if (m_kernelTimestamps && !subscription.queueDelay)
+		{
+			subscription.queueDelay = std::make_unique<LatencyHistogram>();
+		}
+	}
+	return true;
+}
 
-	// Enable or disable receiving based on callback presence
-	// m_enableReceiving = static_cast<bool>(callback);
+bool ArtNetController::unsubscribe(uint16_t first, uint16_t last)
+{
+	if (first > last || last >= ARTNET_PORT_ADDRESS_COUNT)
+	{
+		Logger::error("Invalid Port-Address range: ", first, "..", last);
+		return false;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(m_subscriptionMutex);
+	for (uint32_t universe = first; universe <= last; universe++)
+	{
+		m_subscriptions.remove(static_cast<uint16_t>(universe));
+	}
+	return true;
 }
 
-bool ArtNetController::prepareArtDmxPacket(uint16_t universe,
-		const uint8_t *data, size_t length, std::vector<uint8_t> &packet)
+void ArtNetController::setMergeMode(DmxMerger::Mode mode)
 {
-	if (length > ARTNET_MAX_DMX_SIZE)
+	m_mergeMode = mode;
+}
+
+bool ArtNetController::setMaxMergeSources(size_t count)
+{
+	if (count == 0 || count > DmxMerger::MAX_SOURCES)
 	{
-		Logger::error("DMX data exceeds maximum size (", ARTNET_MAX_DMX_SIZE,
-				" bytes)");
+		Logger::error("Merge sources must be between 1 and ",
+				DmxMerger::MAX_SOURCES);
 		return false;
 	}
 
-	// Calculate total packet size:
-	// ID(8) + OpCode(2) + ProtVer(2) + Sequence(1) + Physical(1) + SubUni(1) +
-	// Net(1) + Length(2) + Data
-	size_t packetSize = 18 + length;
-	packet.resize(packetSize, 0); // Initialize with zeros
+	m_maxMergeSources = count;
+	return true;
+}
 
-	// 1. Setup Header
-	ArtHeader header(OpCode::OpDmx); // This is 0x5000
-	std::memcpy(packet.data(), &header, sizeof(ArtHeader));
-	size_t offset = sizeof(ArtHeader);
+bool ArtNetController::setSourcePriority(const std::string &address,
+		uint8_t priority)
+{
+	in_addr ip;
+	if (inet_pton(AF_INET, address.c_str(), &ip) != 1)
+	{
+		Logger::error("Invalid source address: ", address);
+		return false;
+	}
 
-	// 2. Add Protocol Version (14) in big-endian
-	uint16_t version = htons(14); // Protocol version 14
-	std::memcpy(packet.data() + offset, &version, sizeof(uint16_t));
-	offset += sizeof(uint16_t);
+	std::unique_lock<std::shared_mutex> lock(m_subscriptionMutex);
+	if (priority == DEFAULT_SOURCE_PRIORITY)
+	{
+		m_sourcePriorities.erase(ip.s_addr);
+	}
+	else
+	{
+		m_sourcePriorities[ip.s_addr] = priority;
+	}
+	return true;
+}
 
-	// 3. Sequence number
-	packet[offset++] = static_cast<uint8_t>(m_seqNumber++ & 0xFF);
+bool ArtNetController::setFailoverTimeout(std::chrono::milliseconds timeout)
+{
+	if (timeout < MIN_FAILOVER_TIMEOUT
+			|| timeout > DmxMerger::SOURCE_TIMEOUT)
+	{
+		Logger::error("Failover timeout must be between ",
+				MIN_FAILOVER_TIMEOUT.count(), " and ",
+				std::chrono::milliseconds(DmxMerger::SOURCE_TIMEOUT).count(),
+				" ms");
+		return false;
+	}
 
-	// Rest remains the same...
-	// 4. Physical
-	packet[offset++] = 0;
+	m_failoverTimeout = timeout;
+	return true;
+}
 
-	// 5. SubUni (low byte of 15-bit Port-Address)
-	packet[offset++] = (m_subnet << 4) | (m_universe & 0x0F);
+bool ArtNetController::isSubscribed(uint16_t universe)
+{
+	std::shared_lock<std::shared_mutex> lock(m_subscriptionMutex);
+	return m_subscriptions.contains(universe);
+}
 
-	// 6. Net (high byte of 15-bit Port-Address)
-	packet[offset++] = m_net & 0x7F;
+size_t ArtNetController::readReceivedDmx(uint16_t universe, uint8_t *data,
+		size_t capacity)
+{
+	std::shared_lock<std::shared_mutex> lock(m_subscriptionMutex);
+	Subscription *subscription = m_subscriptions.find(universe);
+	if (!subscription || !subscription->buffered)
+		return 0;
+
+	subscription->buffer.update();
+	const DmxFrame &frame = subscription->buffer.readBuffer();
+	size_t length = std::min<size_t>(frame.length, capacity);
+	std::memcpy(data, frame.data.data(), length);
+	return length;
+}
 
-	// 7. Length in big-endian
-	uint16_t lengthBE = htons(static_cast<uint16_t>(length));
-	memcpy(packet.data() + offset, &lengthBE, sizeof(uint16_t));
-	offset += sizeof(uint16_t);
+bool ArtNetController::getQueueDelay(uint16_t universe,
+		LatencyHistogram::Snapshot &delay)
+{
+	std::shared_lock<std::shared_mutex> lock(m_subscriptionMutex);
+	Subscription *subscription = m_subscriptions.find(universe);
+	if (!subscription || !subscription->queueDelay)
+		return false;
 
-	// 8. DMX data
-	std::memcpy(packet.data() + offset, data, length);
-	return true;
+	delay = subscription->queueDelay->getSnapshot();
+	return delay.count > 0;
+}
+
+void ArtNetController::registerDataCallback(DataCallback callback)
+{
+	std::lock_guard<std::mutex> lock(m_dataMutex);
+
+	m_dataCallback = callback;
+
+	// Enable or disable receiving based on callback presence
+	// m_enableReceiving = static_cast<bool>(callback);
+}
+
+void ArtNetController::registerPacketCallback(PacketCallback callback)
+{
+	std::lock_guard<std::mutex> lock(m_dataMutex);
+	m_packetCallback = callback;
+}
+
+ArtNetController::UniverseState::UniverseState(uint16_t portAddress) :
+		packet
+		{ }
+{
+	// ID(8) + OpCode(2) + ProtVer(2) + Sequence(1) + Physical(1) + SubUni(1) +
+	// Net(1) + Length(2), followed by the DMX data
+	ArtDmxPacket header;
+	header.universe = 0;
+	std::memcpy(packet.data(), &header, ARTDMX_HEADER_SIZE);
+
+	// SubUni (low byte) and Net (high byte) of the 15-bit Port-Address
+	packet[offsetof(ArtDmxPacket, universe)] =
+			static_cast<uint8_t>(portAddress & 0xFF);
+	packet[offsetof(ArtDmxPacket, universe) + 1] =
+			static_cast<uint8_t>((portAddress >> 8) & 0x7F);
+}
+
+void ArtNetController::UniverseState::stampHeader(uint16_t dataLength)
+{
+	// Sequence runs 1..255, 0 would tell receivers to disable reordering
+	sequence = static_cast<uint8_t>(sequence % 255 + 1);
+	packet[offsetof(ArtDmxPacket, sequence)] = sequence;
+
+	// Length in big-endian
+	packet[offsetof(ArtDmxPacket, length)] =
+			static_cast<uint8_t>(dataLength >> 8);
+	packet[offsetof(ArtDmxPacket, length) + 1] =
+			static_cast<uint8_t>(dataLength & 0xFF);
+}
+
+size_t ArtNetController::UniverseState::stampPacket(bool trim)
+{
+	uint16_t dataLength = wireLength(data(), length, trim);
+	stampHeader(dataLength);
+	return ARTDMX_HEADER_SIZE + dataLength;
+}
+
+uint16_t ArtNetController::UniverseState::wireLength(const uint8_t *payload,
+		uint16_t dataLength, bool trim)
+{
+	if (!trim)
+	{
+		highWater = dataLength;
+		tailRepeats = 0;
+		return dataLength;
+	}
+
+	// Round up to the even length the spec asks for, within the data
+	size_t used = utils::usedLength(payload, dataLength);
+	uint16_t trimmed = static_cast<uint16_t>(std::max<size_t>(
+			ARTDMX_MIN_LENGTH, (used + 1) & ~size_t(1)));
+	trimmed = std::min(trimmed, dataLength);
+
+	// Receivers keep channels beyond the length, so a shrinking universe
+	// goes out at its old length until the zeroed tail was seen
+	if (trimmed >= highWater)
+	{
+		highWater = trimmed;
+		tailRepeats = 0;
+		return trimmed;
+	}
+	if (tailRepeats < TAIL_REPEATS)
+	{
+		tailRepeats++;
+		return std::min(highWater, dataLength);
+	}
+	highWater = trimmed;
+	tailRepeats = 0;
+	return trimmed;
 }
 
 // bool ArtNetController::prepareArtPollPacket(std::vector<uint8_t> &packet) {
@@ -588,243 +1448,687 @@ bool ArtNetController::prepareArtDmxPacket(uint16_t universe,
 //   return true;
 // }
 
-bool ArtNetController::sendPacket(const std::vector<uint8_t> &packet,
-		const std::string &address, int port)
+bool ArtNetController::sendPacket(const uint8_t *data, size_t size)
+{
+	return sendPacket(data, size, m_broadcastEndpoint);
+}
+
+bool ArtNetController::sendPacket(const uint8_t *data, size_t size,
+		const Endpoint &destination)
 {
 	if (!m_isRunning || !m_networkInterface)
 	{
 		Logger::error("Not Running or Interface not initialized");
 		return false;
 	}
-	Logger::debug("sendPacket, packet.size: ", packet.size());
+	Logger::debug("sendPacket, packet.size: ", size);
+
+	if (!m_networkInterface->sendPacket(data, size, destination))
+	{
+		Logger::error("Error sending packet");
+		return false;
+	}
+	return true;
+}
 
-	if (address.empty() && port == 0)
+bool ArtNetController::startWorkers()
+{
+	m_keepAliveScheduled = false;
+	m_workers.clear();
+
+	// Frames still held from the last run are dropped, the worker count
+	// may have changed
 	{
-		if (!m_networkInterface->sendPacket(packet, m_broadcastAddress, m_port))
+		std::lock_guard<std::mutex> lock(m_syncMutex);
+		for (SyncHold &hold : m_syncHolds)
 		{
-			Logger::error("Error sending packet");
-			return false;
+			for (uint16_t universe : hold.pending)
+			{
+				m_syncBuffers.find(universe)->pending = false;
+			}
 		}
+		m_syncHolds.assign(m_activeReceiveWorkers, SyncHold());
 	}
-	else
+
+	for (size_t index = 0; index < m_activeReceiveWorkers; index++)
 	{
-		if (!m_networkInterface->sendPacket(packet, address, port))
-		{
-			Logger::error("Error sending packet to specific address");
+		auto worker = std::make_unique<ReceiveWorker>();
+		worker->networkInterface =
+				index == 0 ?
+						m_networkInterface.get() :
+						m_receiveInterfaces[index - 1].get();
+		worker->networkInterface->setNonBlockingReceive(true);
+
+		// Slots receive straight into pool buffers, refilled only where a
+		// consumer kept the previous packet
+		worker->buffers.resize(RECEIVE_BATCH_SIZE);
+		worker->slots.resize(RECEIVE_BATCH_SIZE);
+		worker->overflow.resize(NetworkInterface::MAX_PACKET_SIZE);
+
+		// Waits on the socket, or on what signals io_uring completions
+		ReceiveWorker *state = worker.get();
+		if (!worker->loop.open()
+				|| !worker->loop.addReadable(
+						worker->networkInterface->getReceiveHandle(),
+						[this, state, index]()
+						{
+							receiveBatch(*state, index);
+						}))
 			return false;
+
+		// Hands back the frames this worker held for ArtSync
+		worker->loop.setWakeHandler([this, index]()
+		{
+			std::shared_lock<std::shared_mutex> subscriptionLock(
+					m_subscriptionMutex);
+			std::lock_guard<std::mutex> lock(m_syncMutex);
+			if (m_syncHolds[index].releaseDue)
+			{
+				deliverSyncBuffers(index);
+			}
+		});
+
+		if (index == 0)
+		{
+			m_pollTimer = worker->loop.addTimer([this]()
+			{
+				sendPoll();
+			});
+			m_keepAliveTimer = worker->loop.addTimer([this]()
+			{
+				transmitUniverses(Selection::KeepAlivesOnly);
+			});
+			if (m_pollTimer == -1 || m_keepAliveTimer == -1)
+				return false;
+
+			if (m_enableDiscovery)
+			{
+				sendPoll();
+				worker->loop.armTimer(m_pollTimer, POLL_INTERVAL);
+			}
 		}
+
+		m_workers.push_back(std::move(worker));
 	}
+
+	for (auto &worker : m_workers)
+	{
+		ReceiveWorker *state = worker.get();
+		size_t index = &worker - m_workers.data();
+		worker->thread = std::thread([state, index]()
+		{
+			t_receiveWorker = index;
+			state->networkInterface->prepareReceive();
+			state->loop.run();
+		});
+	}
+
+	Logger::info("Event loop started with ", m_workers.size(),
+			" receive worker(s). bind address: ", m_bindAddress, " port: ",
+			m_port);
 	return true;
 }
 
-void ArtNetController::receivePackets()
+void ArtNetController::stopWorkers()
 {
-	Logger::info("receivePackets thread started. bind address: ", m_bindAddress,
-			" port: ", m_port);
-	std::vector<uint8_t> buffer(NetworkInterface::MAX_PACKET_SIZE); // Large buffer for incoming packets.
+	// Wakes every loop at once, no socket timeout to wait out
+	for (auto &worker : m_workers)
+	{
+		worker->loop.stop();
+	}
+	for (auto &worker : m_workers)
+	{
+		if (worker->thread.joinable())
+		{
+			worker->thread.join();
+		}
+	}
+	m_workers.clear();
+	m_pollTimer = -1;
+	m_keepAliveTimer = -1;
+}
 
-	while (m_isRunning)
+void ArtNetController::receiveBatch(ReceiveWorker &worker, size_t index)
+{
+	size_t ready = refillBuffers(worker);
+	if (ready == 0)
 	{
-		sockaddr_in senderAddr;
-		socklen_t addrLen = sizeof(senderAddr);
-		// No MSG_DONTWAIT flag
-		int bytesReceived = recvfrom(m_networkInterface->getSocket(),
-				buffer.data(), buffer.size(), 0, (struct sockaddr*) &senderAddr,
-				&addrLen);
+		// Every buffer is held by a consumer: drop a datagram rather than
+		// let the loop spin on a readable socket
+		Endpoint sender;
+		if (worker.networkInterface->receivePacket(worker.overflow.data(),
+				worker.overflow.size(), sender) > 0)
+		{
+			m_stats.poolDroppedPackets++;
+		}
+		return;
+	}
 
-		Logger::debug("receivePackets, bytesReceived: ", bytesReceived,
-				" buffer.size: ", buffer.size());
+	// Up to RECEIVE_BATCH_SIZE datagrams per call; if more are queued the
+	// loop reports the socket readable again
+	int received = worker.networkInterface->receivePackets(worker.slots.data(),
+			ready);
 
-		if (bytesReceived > 0)
+	if (received < 0)
+	{
+		if (errno != EINTR)
 		{
-			if (static_cast<size_t>(bytesReceived) <= buffer.size())
-			{
-				handleArtPacket(buffer.data(), static_cast<int>(bytesReceived),
-						senderAddr);
-			}
-			else
-			{
-				Logger::error("Invalid bytesReceived value, ignoring packet");
-			}
+			Logger::error("Error receiving data: ", strerror(errno));
 		}
-		else if (bytesReceived < 0)
+		return;
+	}
+
+	// Kernel timestamps are CLOCK_REALTIME, which system_clock reads
+	std::chrono::nanoseconds pickedUp
+	{ 0 };
+	if (m_kernelTimestamps)
+	{
+		pickedUp = std::chrono::system_clock::now().time_since_epoch();
+	}
+
+	// Subscriptions stay put for the whole batch
+	std::shared_lock<std::shared_mutex> lock(m_subscriptionMutex);
+	for (int i = 0; i < received; i++)
+	{
+		const IncomingPacket &packet = worker.slots[i];
+		worker.buffers[i].setTimestamp(packet.timestamp,
+				packet.timestamp.count() > 0 ?
+						std::max(pickedUp - packet.timestamp,
+								std::chrono::nanoseconds(0)) :
+						std::chrono::nanoseconds(0));
+
+		// Only broadcasts reach every socket of the group, the kernel
+		// filter hands anything else to its owner already
+		if (receiveShard(packet.data, packet.size, m_activeReceiveWorkers)
+				!= index)
+			continue;
+
+		if (packet.size <= packet.capacity)
 		{
-			// Handle error if needed, but don't log if it's just a timeout
-			if (errno != EAGAIN && errno != EWOULDBLOCK)
-			{
-				Logger::error("Error receiving data: ", strerror(errno));
-			}
+			worker.buffers[i].setSize(packet.size);
+			handleArtPacket(packet.data, packet.size, packet.sender.address,
+					worker.buffers[i]);
 		}
-		else if (bytesReceived < 0)
+		else
 		{
-			if (errno == EAGAIN || errno == EWOULDBLOCK)
-			{
-				// Timeout occurred, no data received. This is normal.
-				// Check m_isRunning and continue the loop.
-				if (!m_isRunning)
-				{
-					break;
-				}
-				continue;
-			}
-			else if (errno == EINTR)
-			{
-				// Interrupted by a signal, likely SIGINT or SIGTERM
-				if (!m_isRunning)
-				{
-					break; // Exit the loop if we're supposed to stop
-				}
-			}
-			else
-			{
-				// Other error
-				Logger::error("Error receiving data: ", strerror(errno));
-			}
+			Logger::error("Invalid bytesReceived value, ignoring packet");
 		}
 	}
 }
 
-void ArtNetController::handleArtPacket(const uint8_t *buffer, int size,
-		sockaddr_in senderAddr)
+// Gives every slot a buffer of its own and returns how many have one,
+// packed at the front
+size_t ArtNetController::refillBuffers(ReceiveWorker &worker)
 {
-	if (size < ARTNET_HEADER_SIZE)
+	size_t ready = 0;
+	bool poolEmpty = false;
+	for (size_t i = 0; i < worker.buffers.size(); i++)
 	{
-		Logger::debug("handleArtPacket: invalid size");
-		return; // Ignore invalid packets
+		PacketPool::Ref &buffer = worker.buffers[i];
+		if (buffer && !buffer.unique())
+		{
+			buffer.reset(); // A consumer kept it
+		}
+		if (!buffer && !poolEmpty)
+		{
+			buffer = m_packetPool.acquire();
+			poolEmpty = !buffer;
+		}
+		if (!buffer)
+			continue;
+		if (i != ready)
+		{
+			std::swap(worker.buffers[ready], buffer);
+		}
+
+		worker.slots[ready].data = worker.buffers[ready].mutableData();
+		worker.slots[ready].capacity = PacketPool::SLOT_SIZE;
+		ready++;
 	}
+	return ready;
+}
 
-	// Read directly from the buffer without creating a new header
-	const ArtHeader *header = reinterpret_cast<const ArtHeader*>(buffer);
+const std::array<ArtNetController::PacketHandler, 256> ArtNetController::PACKET_HANDLERS =
+		[]()
+		{
+			std::array<PacketHandler, 256> handlers
+			{ }; // nullptr: not handled
+			handlers[static_cast<uint16_t>(OpCode::OpDmx) >> 8] =
+					&ArtNetController::handleArtDmx;
+			handlers[static_cast<uint16_t>(OpCode::OpSync) >> 8] =
+					&ArtNetController::handleArtSync;
+			handlers[static_cast<uint16_t>(OpCode::OpPoll) >> 8] =
+					&ArtNetController::handleArtPoll;
+			handlers[static_cast<uint16_t>(OpCode::OpPollReply) >> 8] =
+					&ArtNetController::handleArtPollReply;
+			return handlers;
+		}();
+
+void ArtNetController::handleArtPacket(const uint8_t *buffer, size_t size,
+		sockaddr_in senderAddr, const PacketPool::Ref &packet)
+{
+	// One word compare for the ID, one table load for the handler
+	if (!hasArtNetId(buffer, size))
+	{
+		Logger::debug("handleArtPacket: not an Art-Net packet, size ", size);
+		return;
+	}
 
-	// validate id (should be always "Art-Net")
-	if (std::strncmp(reinterpret_cast<const char*>(header->id.data()),
-			"Art-Net", 8) != 0)
+	uint16_t opcode = readOpcode(buffer);
+	PacketHandler handler =
+			(opcode & 0xFF) == 0 ? PACKET_HANDLERS[opcode >> 8] : nullptr;
+	if (!handler)
 	{
-		Logger::error("Invalid Art-Net ID");
+		Logger::error("handleArtPacket opcode: NOT HANDLED ", opcode,
+				" from IP: ", utils::ipAddressToString(senderAddr));
 		return;
 	}
 
-	uint16_t opcode = header->opcode; // Already in little-endian
+	(this->*handler)(buffer, size, senderAddr, packet);
+}
 
-	// std::cout << "Raw opcode: 0x" << std::hex << std::setfill('0') << std::setw(4) << static_cast<int>(opcode) << std::endl;
-	// std::cout << std::dec;
+void ArtNetController::handleArtDmx(const uint8_t *buffer, size_t size,
+		sockaddr_in senderAddr, const PacketPool::Ref &packet)
+{
+	ArtDmxView dmx;
+	if (!dmx.parse(buffer, size))
+	{
+		Logger::debug("handleArtDmx: length exceeds packet size");
+		return;
+	}
 
-	// Dmx
-	if (opcode == static_cast<uint16_t>(OpCode::OpDmx))
+	// One bit test filters, one index finds the subscription
+	uint16_t packetUniverse = dmx.portAddress();
+	if (!m_subscriptions.contains(packetUniverse))
 	{
-		Logger::debug("handleArtPacket opcode: OpDmx ", opcode, " from IP: ",
-				utils::ipAddressToString(senderAddr));
-		handleArtDmx(buffer, size);
+		return;
+	}
+	Subscription &subscription = m_subscriptions.at(packetUniverse);
 
-		// Poll
+	if (subscription.queueDelay && packet && packet.timestamp().count() > 0)
+	{
+		subscription.queueDelay->record(packet.queueDelay());
 	}
-	else if (opcode == static_cast<uint16_t>(OpCode::OpPoll))
+
+	// Drop late or repeated packets, then merge with other sources on this
+	// universe; one source passes through
+	if (!subscription.merger)
 	{
-		Logger::info("handleArtPacket opcode: OpPoll ", opcode, " from IP: ",
+		subscription.merger = std::make_unique<DmxMerger>();
+	}
+	uint8_t priority = DEFAULT_SOURCE_PRIORITY;
+	if (!m_sourcePriorities.empty())
+	{
+		auto it = m_sourcePriorities.find(senderAddr.sin_addr.s_addr);
+		if (it != m_sourcePriorities.end())
+			priority = it->second;
+	}
+	DmxMerger::Settings settings
+	{ m_mergeMode, m_maxMergeSources, m_failoverTimeout.load() };
+	DmxMerger::Result merged = subscription.merger->merge(
+			senderAddr.sin_addr.s_addr, dmx.physical(), priority,
+			dmx.sequence(), dmx.data(), dmx.length(), settings,
+			std::chrono::steady_clock::now());
+	bool merging = subscription.merger->mergingSources() > 1;
+	if (packetUniverse == m_portAddress)
+	{
+		m_outputMerging = merging;
+	}
+
+	switch (merged.status)
+	{
+	case DmxMerger::Status::Output:
+		break;
+	case DmxMerger::Status::SourceRejected:
+		m_stats.rejectedSourcePackets++;
+		return;
+	case DmxMerger::Status::Duplicate:
+		m_stats.duplicatePackets++;
+		return;
+	case DmxMerger::Status::Reordered:
+		m_stats.reorderedPackets++;
+		return;
+	case DmxMerger::Status::Standby:
+		m_stats.standbyPackets++;
+		m_stats.lostPackets += merged.lost;
+		return;
+	}
+	if (merged.lost > 0)
+	{
+		m_stats.lostPackets += merged.lost;
+	}
+	if (merged.sourceSwitch == DmxMerger::Switch::Failover)
+	{
+		m_stats.sourceFailovers++;
+		Logger::info("Universe ", packetUniverse, " failed over to ",
 				utils::ipAddressToString(senderAddr));
+	}
+	else if (merged.sourceSwitch == DmxMerger::Switch::Recovery)
+	{
+		m_stats.sourceRecoveries++;
+		Logger::info("Universe ", packetUniverse, " recovered to ",
+				utils::ipAddressToString(senderAddr));
+	}
+	if (merging)
+	{
+		m_stats.mergedPackets++;
+	}
 
-		handleArtPoll(buffer, size, senderAddr);
+	if (m_packetCallback)
+	{
+		m_packetCallback(packetUniverse, packet, dmx.data(), dmx.length());
+	}
 
-		// PollReply
+	// Hold the data back while a sender is driving us with ArtSync
+	if (bufferForSync(packetUniverse, merged.data, merged.length))
+	{
+		return;
 	}
-	else if (opcode == static_cast<uint16_t>(OpCode::OpPollReply))
+
+	deliverDmx(subscription, merged.data, merged.length);
+}
+
+// Caller holds m_subscriptionMutex
+void ArtNetController::deliverDmx(Subscription &subscription,
+		const uint8_t *data, uint16_t length)
+{
+	if (subscription.buffered)
 	{
-		Logger::info("handleArtPacket opcode: OpPollReply ", opcode,
-				" from IP: ", utils::ipAddressToString(senderAddr));
+		DmxFrame &frame = subscription.buffer.writeBuffer();
+		std::memcpy(frame.data.data(), data, length);
+		frame.length = length;
+		subscription.buffer.publish();
+	}
+
+	// TODO: Rename it to dataDMXCallback
+	const DataCallback &callback =
+			subscription.callback ? subscription.callback : m_dataCallback;
+	if (!callback)
+		return;
 
-		handleArtPollReply(buffer, size);
+	if (m_dispatcher.isRunning())
+	{
+		dispatchDmx(subscription, data, length);
+		return;
 	}
-	else
+	callback(subscription.universe, data, length);
+}
+
+// Receive worker side of the callback offload
+void ArtNetController::dispatchDmx(Subscription &subscription,
+		const uint8_t *data, uint16_t length)
+{
+	if (m_dispatchPolicy == CallbackDispatcher::Policy::Drop)
 	{
-		// Unhandled opcode
-		Logger::error("handleArtPacket opcode: NOT HANDLED ", opcode,
-				" from IP: ", utils::ipAddressToString(senderAddr));
+		if (!m_dispatcher.push(t_receiveWorker, subscription.universe, data,
+				length))
+		{
+			m_stats.dispatchDropped++;
+		}
+		return;
 	}
 
-	// TODO: Handle more opcodes as needed
+	// Coalesce: the frame goes to the universe's own triple buffer and the
+	// ring only carries a notification while none is outstanding
+	DmxFrame &frame = subscription.dispatchBuffer.writeBuffer();
+	std::memcpy(frame.data.data(), data, length);
+	frame.length = length;
+	if (!subscription.dispatchBuffer.publish())
+	{
+		m_stats.dispatchCoalesced++;
+	}
+
+	if (subscription.dispatchQueued.exchange(true))
+		return;
+	if (!m_dispatcher.push(t_receiveWorker, subscription.universe, nullptr, 0))
+	{
+		// The frame stays buffered, the next packet tries again
+		subscription.dispatchQueued = false;
+		m_stats.dispatchDropped++;
+	}
 }
 
-void ArtNetController::handleArtDmx(const uint8_t *buffer, int size)
+// Dispatch worker side, runs the callback outside the receive thread
+void ArtNetController::runDispatched(const CallbackDispatcher::Item &item)
 {
-	if (size < ARTNET_HEADER_SIZE + 4)
+	std::shared_lock<std::shared_mutex> lock(m_subscriptionMutex);
+	Subscription *subscription = m_subscriptions.find(item.universe);
+	if (!subscription)
+		return;
+
+	const DataCallback &callback =
+			subscription->callback ? subscription->callback : m_dataCallback;
+	if (!callback)
 		return;
 
-	// Interpret buffer as an ArtDmxPacket
-	const ArtDmxPacket *dmxPacket =
-			reinterpret_cast<const ArtDmxPacket*>(buffer);
+	if (m_dispatchPolicy == CallbackDispatcher::Policy::Drop)
+	{
+		callback(item.universe, item.data.data(), item.length);
+		return;
+	}
 
-	uint16_t packetUniverse = ntohs(dmxPacket->universe); // Convert from network byte order
-	uint16_t dmxLength = ntohs(dmxPacket->length); // Convert from network byte order
-	uint8_t net = (packetUniverse >> 12) & 0x7F;
-	uint8_t subnet = (packetUniverse >> 8) & 0xF;
-	uint8_t uni = packetUniverse & 0xF;
+	// Clear the flag before taking the frame, so a frame published after
+	// this point queues a new notification
+	subscription->dispatchQueued.store(false);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (!subscription->dispatchBuffer.update())
+		return; // Already delivered by an earlier notification
 
-	// Filter packets based on universe addressing
-	if (net != m_net || subnet != m_subnet || uni != m_universe)
+	const DmxFrame &frame = subscription->dispatchBuffer.readBuffer();
+	callback(item.universe, frame.data.data(), frame.length);
+}
+
+void ArtNetController::handleArtSync(const uint8_t *buffer, size_t size,
+		[[maybe_unused]] sockaddr_in senderAddr,
+		[[maybe_unused]] const PacketPool::Ref &packet)
+{
+	ArtSyncView sync;
+	if (!sync.parse(buffer, size))
 	{
+		Logger::debug("handleArtSync: invalid size ", size);
 		return;
 	}
 
-	// Check if the data callback is set and invoke it
-	if (m_dataCallback)
+	m_stats.syncPacketsReceived++;
+	std::lock_guard<std::mutex> lock(m_syncMutex);
+	m_syncActive = true;
+	m_lastSyncTime = std::chrono::steady_clock::now();
+	releaseSyncBuffers();
+}
+
+bool ArtNetController::bufferForSync(uint16_t universe, const uint8_t *data,
+		uint16_t length)
+{
+	if (!m_syncActive)
+		return false;
+
+	std::lock_guard<std::mutex> lock(m_syncMutex);
+	if (!m_syncActive)
+		return false; // Timed out on another worker meanwhile
+
+	// Frames held for the last ArtSync leave before this one is held
+	if (m_syncHolds[t_receiveWorker].releaseDue)
+	{
+		deliverSyncBuffers(t_receiveWorker);
+	}
+
+	if (std::chrono::steady_clock::now() - m_lastSyncTime > SYNC_TIMEOUT)
+	{
+		// Sender stopped syncing: deliver what is held and go immediate
+		Logger::info("ArtSync timed out, reverting to immediate output");
+		m_syncActive = false;
+		releaseSyncBuffers();
+		return false;
+	}
+
+	SyncBuffer &buffer = m_syncBuffers.acquire(universe);
+	std::memcpy(buffer.data.data(), data, length);
+	buffer.length = length;
+	if (!buffer.pending)
+	{
+		buffer.pending = true;
+		m_syncHolds[t_receiveWorker].pending.push_back(universe);
+	}
+	return true;
+}
+
+// Delivers this worker's held frames and wakes the other workers holding
+// some. Caller holds m_syncMutex and m_subscriptionMutex.
+void ArtNetController::releaseSyncBuffers()
+{
+	for (size_t worker = 0; worker < m_syncHolds.size(); worker++)
+	{
+		SyncHold &hold = m_syncHolds[worker];
+		if (hold.pending.empty())
+			continue;
+
+		if (worker == t_receiveWorker)
+		{
+			deliverSyncBuffers(worker);
+		}
+		else if (!hold.releaseDue)
+		{
+			hold.releaseDue = true;
+			m_workers[worker]->loop.wake();
+		}
+	}
+}
+
+// On the owning worker, caller holds m_syncMutex and m_subscriptionMutex
+void ArtNetController::deliverSyncBuffers(size_t worker)
+{
+	SyncHold &hold = m_syncHolds[worker];
+	hold.releaseDue = false;
+	for (uint16_t universe : hold.pending)
 	{
-		// TODO: Rename it to dataDMXCallback
-		m_dataCallback(packetUniverse, dmxPacket->data, dmxLength); // Access `data` directly
+		SyncBuffer &buffer = *m_syncBuffers.find(universe);
+		buffer.pending = false;
+
+		// Skipped if it was unsubscribed while held back
+		Subscription *subscription = m_subscriptions.find(universe);
+		if (subscription)
+		{
+			deliverDmx(*subscription, buffer.data.data(), buffer.length);
+		}
 	}
+	hold.pending.clear();
 }
 
-void ArtNetController::handleArtPoll([[maybe_unused]] const uint8_t *buffer,
-		int size, sockaddr_in senderAddr)
+void ArtNetController::handleArtPoll(const uint8_t *buffer, size_t size,
+		sockaddr_in senderAddr, [[maybe_unused]] const PacketPool::Ref &packet)
 {
-	if (size < ARTNET_HEADER_SIZE + 2)
+	Logger::info("handleArtPacket opcode: OpPoll from IP: ",
+			utils::ipAddressToString(senderAddr));
+
+	// Our own broadcast poll, answering it would make us a node
+	if (isLocalSender(senderAddr))
+		return;
+
+	ArtPollView poll;
+	if (!poll.parse(buffer, size))
 	{
 		Logger::error("handleArtPoll: Invalid ArtPollPacket size: ", size);
 		return;
 	}
 
-	ArtPollPacket pollPacket;
-	std::memset(&pollPacket, 0, sizeof(pollPacket));
-	std::memcpy(&pollPacket, buffer,
-			std::min((size_t) size, sizeof(pollPacket)));
-
-	Logger::debug("Received Poll Packet");
+	Logger::debug("Received Poll Packet, flags ", static_cast<int>(poll.flags()));
 	sendPollReply(buffer, senderAddr);
 }
 
-void ArtNetController::handleArtPollReply(const uint8_t *buffer, int size)
+void ArtNetController::handleArtPollReply(const uint8_t *buffer, size_t size,
+		sockaddr_in senderAddr, [[maybe_unused]] const PacketPool::Ref &packet)
 {
-	if (size < 207)
+	Logger::info("handleArtPacket opcode: OpPollReply from IP: ",
+			utils::ipAddressToString(senderAddr));
+
+	// Nodes on this host are not routed to, broadcast still reaches them
+	if (isLocalSender(senderAddr))
+		return;
+
+	ArtPollReplyView view;
+	if (!view.parse(buffer, size))
 	{
 		Logger::error(
 				"handleArtPollReply: Packet size is less than the minimum 207 bytes");
 		return;
 	}
 
-	// Check if the packet is an ArtPollReply
-	if (std::strncmp(reinterpret_cast<const char*>(buffer), "Art-Net", 8) != 0)
+	// Fields past 'MAC Lo' are optional, missing ones stay zero
+	ArtPollReplyPacket reply;
+	view.copyTo(reply);
+
+	NodeInfo node;
+	std::memcpy(node.ip.data(), reply.ip, sizeof(reply.ip));
+	node.port = reply.port; // Little-endian on the wire
+	node.oem = ntohs(reply.oem);
+	node.netSwitch = reply.netSwitch & 0x7F;
+	node.subSwitch = reply.subSwitch & 0x0F;
+	node.bindIndex = reply.bindIndex;
+	node.endpoint = Endpoint(senderAddr.sin_addr, m_port);
+	node.shortName.assign(reinterpret_cast<const char*>(reply.shortName.data()),
+			strnlen(reinterpret_cast<const char*>(reply.shortName.data()),
+					reply.shortName.size()));
+	node.longName.assign(reinterpret_cast<const char*>(reply.longName.data()),
+			strnlen(reinterpret_cast<const char*>(reply.longName.data()),
+					reply.longName.size()));
+	node.lastSeen = std::chrono::steady_clock::now();
+
+	// Every output port of this bind index subscribes to one universe
+	size_t numPorts = std::min<size_t>(ntohs(reply.numPorts),
+			reply.portType.size());
+	for (size_t i = 0; i < numPorts; i++)
 	{
-		Logger::error("handleArtPollReply: Not an ArtPollReply packet");
-		return;
+		if (reply.portType[i] & 0x80) // Can output DMX512 from Art-Net
+		{
+			node.subscribedUniverses.push_back(
+					makePortAddress(node.netSwitch, node.subSwitch,
+							reply.swOut[i]));
+		}
 	}
 
-	// Assuming a packet of 207 bytes or more, we can safely extract fields up to 'MAC Lo'
-	// Extract essential fields manually, without casting the entire buffer
-	size_t offset = ARTNET_HEADER_SIZE;
+	std::string key = utils::ipAddressToString(senderAddr) + "/"
+			+ std::to_string(node.bindIndex);
+
+	Logger::debug("Received ArtPollReply packet from: ", key, " outputs ",
+			node.subscribedUniverses.size());
 
-	std::array<uint8_t, 4> ip;
-	std::memcpy(ip.data(), buffer + offset, sizeof(ip));
-	offset += sizeof(ip);
+	std::lock_guard<std::mutex> lock(m_nodesMutex);
+	auto it = m_discoveredNodes.find(key);
+	bool changed = it == m_discoveredNodes.end()
+			|| it->second.subscribedUniverses != node.subscribedUniverses;
+	m_discoveredNodes[key] = std::move(node);
+
+	if (changed)
+		rebuildRoutes();
+}
+
+bool ArtNetController::isLocalSender(const sockaddr_in &sender) const
+{
+	return std::find(m_localAddresses.begin(), m_localAddresses.end(),
+			sender.sin_addr.s_addr) != m_localAddresses.end();
+}
 
-	uint16_t port;
-	std::memcpy(&port, buffer + offset, sizeof(port));
-	offset += sizeof(port);
+// Caller holds m_nodesMutex
+void ArtNetController::rebuildRoutes()
+{
+	m_routes.clear();
 
-	// Convert port to host byte order
-	port = ntohs(port);
+	for (const auto &entry : m_discoveredNodes)
+	{
+		const NodeInfo &node = entry.second;
+		for (uint16_t universe : node.subscribedUniverses)
+		{
+			std::vector<Endpoint> &endpoints = m_routes[universe];
+			// Bound devices of one node share its address
+			if (std::find(endpoints.begin(), endpoints.end(), node.endpoint)
+					== endpoints.end())
+			{
+				endpoints.push_back(node.endpoint);
+			}
+		}
+	}
 
-	// Now, you can use the extracted IP and port for logging or further processing
-	Logger::debug("Received ArtPollReply packet from: ",
-			static_cast<int>(ip[0]), ".", static_cast<int>(ip[1]), ".",
-			static_cast<int>(ip[2]), ".", static_cast<int>(ip[3]), ":", port);
+	m_stats.discoveredNodes = m_discoveredNodes.size();
+	m_stats.routedUniverses = m_routes.size();
 }
 } // namespace ArtNet
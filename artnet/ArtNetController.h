@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -8,13 +9,23 @@
 #include <memory>
 #include <mutex>
 #include <netinet/in.h>
-#include <queue>
+#include <shared_mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "NetworkInterface.h"
 #include "artnet_types.h"
+#include "callback_dispatcher.h"
+#include "dmx_merger.h"
+#include "event_loop.h"
+#include "frame_scheduler.h"
+#include "packet_pacer.h"
+#include "packet_pool.h"
+#include "subscription_table.h"
+#include "triple_buffer.h"
+#include "universe_table.h"
 
 // forward declaration
 // class NetworkInterface;
@@ -28,32 +39,162 @@ public:
 	// Data Handling
 	using DataCallback = std::function<void(uint16_t universe, const uint8_t *data, uint16_t length)>;
 	using FrameGenerator = std::function<std::vector<uint8_t>()>;
+	// Accepted ArtDmx datagram, still in its receive buffer. `data` points
+	// into `packet` and stays valid for as long as a copy of it is held.
+	using PacketCallback = std::function<void(uint16_t universe,
+			const PacketPool::Ref &packet, const uint8_t *data, uint16_t length)>;
+
+	// Writable view into the controller-owned buffer of one universe. `data`
+	// holds the previous frame and has room for ARTNET_MAX_DMX_SIZE bytes.
+	struct UniverseFrame
+	{
+		uint16_t universe; // Port-Address
+		uint8_t *data;
+		uint16_t length;   // Channels in use, the renderer may change it
+	};
+	// Fills the next frame in place and sets dirty[i] for every changed view.
+	// `dirty` has one entry per view and is cleared before each call.
+	using FrameRenderer = std::function<void(UniverseFrame *frames, size_t count,
+			std::vector<bool> &dirty)>;
+
+	// When universes are put on the wire
+	enum class TransmitMode
+	{
+		Continuous, // Every setDmxData() queues the universe for sending
+		OnChange    // Only payloads that differ from the last one are queued
+	};
+
+	// Art-Net 4 keep-alive window for unchanged universes
+	static constexpr std::chrono::milliseconds MIN_REFRESH_INTERVAL
+	{ 800 };
+	static constexpr std::chrono::milliseconds MAX_REFRESH_INTERVAL
+	{ 4000 };
+
+	// Receivers fall back to immediate output when ArtSync stops for this long
+	static constexpr std::chrono::milliseconds SYNC_TIMEOUT
+	{ 4000 };
+
+	// Discovery timing (spec: poll every 2.5 to 3 s, drop nodes missing 3 polls)
+	static constexpr std::chrono::milliseconds POLL_INTERVAL
+	{ 3000 };
+	static constexpr std::chrono::milliseconds NODE_TIMEOUT
+	{ 10000 };
+	static constexpr size_t DEFAULT_MAX_UNICAST_NODES = 40;
+
+	// Receive-side source priorities and failover
+	static constexpr uint8_t DEFAULT_SOURCE_PRIORITY = 100;
+	static constexpr std::chrono::milliseconds DEFAULT_FAILOVER_TIMEOUT
+	{ 1000 };
+	static constexpr std::chrono::milliseconds MIN_FAILOVER_TIMEOUT
+	{ 10 };
+
+	// Keep-alive check of the event loop while no frame processor runs
+	static constexpr std::chrono::milliseconds KEEP_ALIVE_CHECK_INTERVAL
+	{ 250 };
+
+	// Datagrams a receive thread can take per syscall
+	static constexpr size_t RECEIVE_BATCH_SIZE = 64;
+	static constexpr size_t MAX_RECEIVE_WORKERS = 16;
+	// Frames per receive worker -> dispatch worker ring
+	static constexpr size_t DEFAULT_DISPATCH_RING_SIZE = 256;
 
 	// Statistics structure for monitoring
 	struct Statistics
 	{
 		std::atomic<uint64_t> totalFrames
 		{ 0 };
-		std::atomic<uint64_t> droppedFrames
-		{ 0 };
-		std::atomic<size_t> queueDepth
+		std::atomic<uint64_t> droppedFrames // Replaced before the sender took them
 		{ 0 };
 		std::chrono::microseconds lastFrameTime
 		{ 0 };
+		std::atomic<uint64_t> unchangedUpdates // Suppressed by OnChange mode
+		{ 0 };
+		std::atomic<uint64_t> keepAlivePackets
+		{ 0 };
+		std::atomic<uint64_t> syncPacketsSent
+		{ 0 };
+		std::atomic<uint64_t> syncPacketsReceived
+		{ 0 };
+		std::atomic<uint64_t> trimmedBytes // Not sent thanks to trimmed ArtDmx
+		{ 0 };
+		std::atomic<uint64_t> mergedPackets // Received while sources merge
+		{ 0 };
+		std::atomic<uint64_t> rejectedSourcePackets // From one source too many
+		{ 0 };
+		std::atomic<uint64_t> reorderedPackets // Dropped, older than seen
+		{ 0 };
+		std::atomic<uint64_t> duplicatePackets // Dropped, same sequence
+		{ 0 };
+		std::atomic<uint64_t> lostPackets // Gaps in the sequence
+		{ 0 };
+		std::atomic<uint64_t> standbyPackets // From a backup source, not output
+		{ 0 };
+		std::atomic<uint64_t> sourceFailovers // Output moved to a backup
+		{ 0 };
+		std::atomic<uint64_t> sourceRecoveries // Output back on a higher priority
+		{ 0 };
+		std::atomic<uint64_t> dispatchCoalesced // Replaced before dispatch
+		{ 0 };
+		std::atomic<uint64_t> dispatchDropped // Dispatch ring was full
+		{ 0 };
+		std::atomic<uint64_t> poolDroppedPackets // No free receive buffer
+		{ 0 };
+		std::atomic<uint64_t> discoveredNodes // Bound devices answering ArtPoll
+		{ 0 };
+		std::atomic<uint64_t> routedUniverses // With unicast subscribers
+		{ 0 };
 
 		struct Snapshot
 		{
 			uint64_t totalFrames;
 			uint64_t droppedFrames;
-			size_t queueDepth;
+			size_t queueDepth; // 1 while a frame waits for the sender
 			std::chrono::microseconds lastFrameTime;
+			uint64_t unchangedUpdates;
+			uint64_t keepAlivePackets;
+			uint64_t syncPacketsSent;
+			uint64_t syncPacketsReceived;
+			uint64_t trimmedBytes;
+			uint64_t mergedPackets;
+			uint64_t rejectedSourcePackets;
+			uint64_t reorderedPackets;
+			uint64_t duplicatePackets;
+			uint64_t lostPackets;
+			uint64_t standbyPackets;
+			uint64_t sourceFailovers;
+			uint64_t sourceRecoveries;
+			uint64_t dispatchCoalesced;
+			uint64_t dispatchDropped;
+			uint64_t poolDroppedPackets;
+			uint64_t discoveredNodes;
+			uint64_t routedUniverses;
+			uint64_t packetsSent;  // Filled from the network interface
+			uint64_t sendSyscalls; // Filled from the network interface
+			uint64_t packetsReceived;     // Filled from the network interface
+			uint64_t receiveSyscalls;     // Filled from the network interface
+			uint64_t largestReceiveBatch; // Filled from the network interface
+			FrameScheduler::Statistics scheduler; // Filled from the scheduler
+			PacketPacer::Statistics pacing;       // Filled from the pacer
+			PacketPool::Statistics receivePool;   // Filled from the pool
+			LatencyHistogram::Snapshot sendDelay; // Filled from the network interface
 		};
 
 		Snapshot getSnapshot() const
 		{
 			return Snapshot
-			{ totalFrames.load(), droppedFrames.load(), queueDepth.load(),
-					lastFrameTime };
+			{ totalFrames.load(), droppedFrames.load(), 0,
+					lastFrameTime, unchangedUpdates.load(),
+					keepAlivePackets.load(), syncPacketsSent.load(),
+					syncPacketsReceived.load(), trimmedBytes.load(),
+					mergedPackets.load(), rejectedSourcePackets.load(),
+					reorderedPackets.load(), duplicatePackets.load(),
+					lostPackets.load(), standbyPackets.load(),
+					sourceFailovers.load(), sourceRecoveries.load(),
+					dispatchCoalesced.load(),
+					dispatchDropped.load(), poolDroppedPackets.load(),
+					discoveredNodes.load(), routedUniverses.load(), 0, 0,
+					0, 0, 0,
+					{ }, { }, { }, { } };
 		}
 	};
 
@@ -67,83 +208,391 @@ public:
 
 	// Networking
 	bool start();
+	// An empty generator runs the frame processor on frames from submitFrame()
 	bool start(FrameGenerator generator, int fps = 30);
+	// Renders `universes` in place every frame, without allocating
+	bool start(FrameRenderer renderer, const std::vector<uint16_t> &universes,
+			int fps = 30);
 	void stop();
 	bool isRunning() const;
 
 	// Data Management
+	// `universe` is the full 15-bit Port-Address (see makePortAddress)
 	bool setDmxData(uint16_t universe, const std::vector<uint8_t> &data);
 	bool setDmxData(uint16_t universe, const uint8_t *data, size_t length);
 	std::vector<uint8_t> getDmxData(uint16_t universe);
 
 	// Sending
-	bool sendDmx();
-	// bool sendPoll();
+	bool sendDmx(); // All universes holding data
+	bool sendDmx(uint16_t universe);
+	// Sends caller-owned data without copying it: the universe's header and
+	// `data` go out as two segments of one datagram. The buffer is only read
+	// during the call and the stored universe data is left untouched.
+	bool sendDmx(uint16_t universe, const uint8_t *data, size_t length);
+	// Universes updated since their last send plus any universe due for a
+	// keep-alive refresh, in one batch. Call it once per frame.
+	bool flushDmx();
+	bool sendPoll();
 	void sendPollReply(const uint8_t *buffer, sockaddr_in senderAddr);
 
+	// Hands the next frame for the configured universe to the frame
+	// processor. Lock-free and never blocks; only the newest frame is kept.
+	// Call from a single producer thread, not together with a FrameGenerator.
+	bool submitFrame(const uint8_t *data, size_t length);
+
 	// Receiving
 	void registerDataCallback(DataCallback callback);
+	// Called on the receive thread for every ArtDmx packet of a subscribed
+	// universe that passes the sequence, priority and merge checks, before
+	// it is held for ArtSync. The data is the packet's own, not the merge.
+	void registerPacketCallback(PacketCallback callback);
+	// Receives Port-Addresses first..last (inclusive). An empty callback
+	// delivers through registerDataCallback(); `buffered` also keeps the
+	// newest frame for readReceivedDmx(). configure() resets the
+	// subscriptions to the configured universe. Do not call from a callback.
+	bool subscribe(uint16_t first, uint16_t last,
+			DataCallback callback = nullptr, bool buffered = false);
+	bool unsubscribe(uint16_t first, uint16_t last);
+	bool isSubscribed(uint16_t universe);
+	// How ArtDmx from several sources to one universe is merged
+	void setMergeMode(DmxMerger::Mode mode);
+	// Sources merged per universe (spec: 2), others are ignored. Backup
+	// sources count against it too.
+	bool setMaxMergeSources(size_t count);
+	// Priority of every source sending from `address`, higher wins. Only
+	// the highest live priority of a universe is output, lower ones stand
+	// by. All sources start at DEFAULT_SOURCE_PRIORITY.
+	bool setSourcePriority(const std::string &address, uint8_t priority);
+	// Silence after which a higher-priority source hands over to the next
+	// one, a few frame intervals at least
+	bool setFailoverTimeout(std::chrono::milliseconds timeout);
+	// Copies the newest frame of a buffered subscription and returns its
+	// length, 0 if there is none. One reader thread per universe.
+	size_t readReceivedDmx(uint16_t universe, uint8_t *data, size_t capacity);
+	// Socket buffer wait of a subscribed universe's packets, with kernel
+	// timestamps on. False if none was measured.
+	bool getQueueDelay(uint16_t universe, LatencyHistogram::Snapshot &delay);
 
 	// Statistics
-	Statistics::Snapshot getStatistics() const
-	{
-		return m_stats.getSnapshot();
-	}
+	Statistics::Snapshot getStatistics() const;
 
 	// Feature Gate
 	void setEnableSendingDMX(bool enable);
+	void setTransmitMode(TransmitMode mode);
+	// Follow every sendDmx()/flushDmx() batch with an ArtSync
+	void setEnableSyncOutput(bool enable);
+	// Send ArtDmx only up to the last non-zero channel
+	void setEnableTrimmedDmx(bool enable);
+	// Poll for nodes every POLL_INTERVAL from the event loop
+	void setEnableDiscovery(bool enable);
+	// Universes with more subscribers than this are broadcast, 0 disables unicast
+	void setMaxUnicastNodes(size_t count);
+	bool setRefreshInterval(std::chrono::milliseconds interval);
+	// Frame processor pacing, only while stopped
+	bool setFrameScheduler(FrameScheduler::Strategy strategy,
+			FrameScheduler::OverrunPolicy policy =
+					FrameScheduler::OverrunPolicy::SkipAhead);
+	// Spreads each batch over `fraction` of the frame interval, 0 disables
+	bool setPacketPacing(double fraction);
+	// Receive threads, each on its own SO_REUSEPORT socket, only while
+	// stopped. With more than one, the DataCallback runs on several threads
+	// but each universe always on the same one. Without kernel sharding
+	// (Linux only) start() receives on one thread.
+	bool setReceiveWorkers(size_t count);
+	// Kernel software timestamps (Linux): receive time on every packet,
+	// per-universe queueing delay and send delay. Only while stopped.
+	bool setEnableKernelTimestamps(bool enable);
+	// Backend for the sockets start() opens, only while stopped. IoUring
+	// falls back to Sockets where the kernel cannot set it up.
+	bool setNetworkBackend(NetworkBackend backend);
+	// Backend in use while running, the requested one otherwise
+	NetworkBackend getNetworkBackend() const;
+	// Receive buffers shared by all workers, including the ones consumers
+	// hold on to. 0 (default) sizes it for two batches per worker. Only
+	// while stopped.
+	bool setReceivePoolSize(size_t slots);
+	// Byte rate cap for the interface, 0 removes it
+	void setMaxByteRate(uint64_t bytesPerSecond);
+	// Runs DataCallbacks on `workers` threads fed through lock-free rings
+	// instead of on the receive threads, 0 (default) calls them inline.
+	// Each universe stays on one worker. Only while stopped.
+	bool setCallbackDispatch(size_t workers,
+			CallbackDispatcher::Policy policy =
+					CallbackDispatcher::Policy::Coalesce,
+			size_t ringCapacity = DEFAULT_DISPATCH_RING_SIZE);
+	// Occupancy of every receive worker -> dispatch worker ring
+	std::vector<CallbackDispatcher::RingStatistics> getDispatchStatistics() const;
 	// void setEnableReceiving(bool enable);
 
 private:
 	void startFrameProcessor();
+	bool renderFrame();
 	void logDmxData(const std::vector<uint8_t> &dmxData);
 
 	// Network Related
 	std::unique_ptr<NetworkInterface> m_networkInterface;
+	// Sockets of receive workers 1..n-1, worker 0 uses m_networkInterface
+	std::vector<std::unique_ptr<NetworkInterface>> m_receiveInterfaces;
+
+	NetworkBackend m_networkBackend = NetworkBackend::Sockets;
+
+	static std::unique_ptr<NetworkInterface> createNetworkInterface(
+			NetworkBackend backend);
 
 	// Art-Net Parameters
 	std::string m_bindAddress;
 	int m_port;
 	std::string m_broadcastAddress;
+	Endpoint m_broadcastEndpoint; // Resolved once in configure()
 
 	uint8_t m_net;
 	uint8_t m_subnet;
 	uint8_t m_universe;
+	uint16_t m_portAddress; // Combined net/subnet/universe from configure()
 
 	// Internal State
-	static constexpr size_t MAX_QUEUE_SIZE = 4;
 	bool m_isRunning = false;
 	bool m_isConfigured = false;
 	bool m_enableSendingDMX = false;
-	std::thread m_receiveThread;
+	std::atomic<bool> m_enableSyncOutput
+	{ false };
+	std::atomic<bool> m_enableTrimmedDmx
+	{ false };
+	std::atomic<bool> m_enableDiscovery
+	{ false };
+	std::atomic<TransmitMode> m_transmitMode
+	{ TransmitMode::Continuous };
+	std::chrono::milliseconds m_refreshInterval
+	{ 1000 }; // Guarded by m_dataMutex
+	size_t m_receiveWorkers = 1;
+	// Workers start() runs, 1 where the kernel cannot shard the sockets
+	size_t m_activeReceiveWorkers = 1;
 	std::mutex m_dataMutex;
-	std::vector<uint8_t> m_dmxData;
-	uint16_t m_seqNumber;
 	DataCallback m_dataCallback;
 
+	// Outgoing DMX state of one universe. The ArtDmx packet lives here
+	// pre-built: the constant header is written once when the slot is created
+	// and setDmxData() copies straight into the payload, so sending only has
+	// to patch the sequence and length fields.
+	struct alignas(CACHE_LINE_SIZE) UniverseState
+	{
+		explicit UniverseState(uint16_t portAddress);
+
+		uint8_t* data()
+		{
+			return packet.data() + ARTDMX_HEADER_SIZE;
+		}
+
+		const uint8_t* data() const
+		{
+			return packet.data() + ARTDMX_HEADER_SIZE;
+		}
+
+		// Advances the sequence and patches the header for `dataLength` bytes
+		void stampHeader(uint16_t dataLength);
+		// Stamps the header for the stored data and returns the packet size
+		size_t stampPacket(bool trim);
+		// Length to put on the wire for `payload`. Trimming never drops
+		// channels sent before until their zeros went out TAIL_REPEATS times.
+		uint16_t wireLength(const uint8_t *payload, uint16_t dataLength,
+				bool trim);
+
+		static constexpr uint8_t TAIL_REPEATS = 3;
+
+		std::array<uint8_t, ARTDMX_HEADER_SIZE + ARTNET_MAX_DMX_SIZE> packet;
+		uint16_t length = 0;
+		uint8_t sequence = 0;
+		bool pending = false; // Updated since last send
+		uint16_t highWater = 0; // Longest length the receivers may hold
+		uint8_t tailRepeats = 0;
+		std::chrono::steady_clock::time_point lastSent;
+	};
+
+	UniverseTable<UniverseState> m_universes; // Guarded by m_dataMutex
+
 	// Frame Processing
-	std::queue<std::vector<uint8_t>> m_frameQueue;
-	std::mutex m_queueMutex;
+	struct DmxFrame
+	{
+		std::array<uint8_t, ARTNET_MAX_DMX_SIZE> data;
+		uint16_t length = 0;
+	};
+	TripleBuffer<DmxFrame> m_frameBuffer; // Producer -> frame processor
 	std::thread m_processorThread;
 	std::chrono::microseconds m_frameInterval;
+	FrameScheduler m_scheduler; // Used by the frame processor thread
 	FrameGenerator m_frameGenerator;
+	FrameRenderer m_frameRenderer;
+	std::vector<UniverseFrame> m_renderFrames; // Preallocated views
+	std::vector<bool> m_renderDirty;
 	Statistics m_stats;
 
 	// Core Logic
-	bool prepareArtDmxPacket(uint16_t universe, const uint8_t *data,
-			size_t length, std::vector<uint8_t> &packet);
 	// bool prepareArtPollPacket(std::vector<uint8_t> &packet);
 
-	bool sendPacket(const std::vector<uint8_t> &packet,
-			const std::string &address = "", int port = 0);
+	bool sendPacket(const uint8_t *data, size_t size);
+	bool sendPacket(const uint8_t *data, size_t size,
+			const Endpoint &destination);
+	// Which universes transmitUniverses() puts on the wire
+	enum class Selection
+	{
+		All,           // Every universe holding data
+		Updated,       // Pending ones plus those due for a keep-alive
+		KeepAlivesOnly // Only those due for a keep-alive
+	};
+	bool transmitUniverses(Selection selection);
 
-	void receivePackets();
-	void handleArtPacket(const uint8_t *buffer, int size,
-			sockaddr_in senderAddr);
+	// Packet templates to transmit with their destinations, reused across
+	// frames. Guarded by m_dataMutex.
+	std::vector<OutgoingPacket> m_txBatch;
+	const ArtSyncPacket m_syncPacket;
+	// Paced sends hold only m_pacerMutex while they sleep. Configured under
+	// m_dataMutex, then m_pacerMutex.
+	std::mutex m_pacerMutex;
+	PacketPacer m_pacer;            // Guarded by m_pacerMutex
+	double m_pacingFraction = 0;    // Guarded by m_dataMutex
+	uint64_t m_maxByteRate = 0;     // Guarded by m_dataMutex
+
+	void queueUniverse(uint16_t universe, UniverseState &state);
+	void queueRouted(uint16_t universe, OutgoingPacket packet);
+	// Appends ArtSync when sync output is on, caller holds m_dataMutex
+	void queueSync();
+	// Sends m_txBatch; a paced batch is copied and sent after `dataLock`
+	// (on m_dataMutex) has been released. `paced` false skips the pacer.
+	bool sendQueued(std::unique_lock<std::mutex> &dataLock, bool paced = true);
+	void updatePacerWindow();
+
+	// Received universes held back until the next ArtSync
+	struct SyncBuffer
+	{
+		explicit SyncBuffer(uint16_t)
+		{
+		}
+
+		std::array<uint8_t, ARTNET_MAX_DMX_SIZE> data
+		{ };
+		uint16_t length = 0;
+		bool pending = false;
+	};
+
+	// Held universes of one receive worker. Only that worker delivers
+	// them, so a universe's buffers and callbacks keep a single producer.
+	struct SyncHold
+	{
+		std::vector<uint16_t> pending;
+		bool releaseDue = false; // ArtSync seen, not delivered yet
+	};
 
-	void handleArtDmx(const uint8_t *buffer, int size);
-	void handleArtPoll(const uint8_t *buffer, int size, sockaddr_in senderAddr);
-	void handleArtPollReply(const uint8_t *buffer, int size);
+	std::mutex m_syncMutex; // Receive workers share the sync state
+	UniverseTable<SyncBuffer> m_syncBuffers; // Guarded by m_syncMutex
+	std::vector<SyncHold> m_syncHolds;       // Per worker, m_syncMutex
+	std::atomic<bool> m_syncActive
+	{ false };
+	std::chrono::steady_clock::time_point m_lastSyncTime; // m_syncMutex
+
+	bool bufferForSync(uint16_t universe, const uint8_t *data,
+			uint16_t length);
+	void releaseSyncBuffers();
+	void deliverSyncBuffers(size_t worker);
+
+	// One receive thread: an event loop serving one socket with its own
+	// batch slots. Worker 0 also runs the controller's timers.
+	// Receive buffers, declared before the workers that hold slots of it
+	PacketPool m_packetPool;
+	size_t m_packetPoolSize = 0;
+	bool m_kernelTimestamps = false;
+	PacketCallback m_packetCallback;
+
+	struct ReceiveWorker
+	{
+		NetworkInterface *networkInterface;
+		EventLoop loop;
+		std::vector<PacketPool::Ref> buffers; // slots[i] receives into buffers[i]
+		std::vector<IncomingPacket> slots;
+		std::vector<uint8_t> overflow; // Drains the socket while the pool is empty
+		std::thread thread;
+	};
+
+	std::vector<std::unique_ptr<ReceiveWorker>> m_workers; // Worker i reads socket i
+	int m_pollTimer = -1;
+	int m_keepAliveTimer = -1;
+	// Set once keep-alives are taken care of, by the frame processor or
+	// by the keep-alive timer armed on the first send
+	std::atomic<bool> m_keepAliveScheduled
+	{ false };
+
+	// Receive subscription of one universe
+	struct Subscription
+	{
+		explicit Subscription(uint16_t portAddress) :
+				universe(portAddress)
+		{
+		}
+
+		uint16_t universe;
+		DataCallback callback; // Empty: the registered DataCallback
+		bool buffered = false;
+		TripleBuffer<DmxFrame> buffer; // Receive worker -> readReceivedDmx()
+		// Coalescing dispatch: newest frame, and whether its dispatch worker
+		// already has a notification queued
+		TripleBuffer<DmxFrame> dispatchBuffer;
+		std::atomic<bool> dispatchQueued
+		{ false };
+		std::unique_ptr<DmxMerger> merger; // Created by the first packet
+		// With kernel timestamps on, recorded by the universe's worker
+		std::unique_ptr<LatencyHistogram> queueDelay;
+	};
+	std::atomic<DmxMerger::Mode> m_mergeMode
+	{ DmxMerger::Mode::HTP };
+	std::atomic<size_t> m_maxMergeSources
+	{ 2 };
+	std::atomic<std::chrono::milliseconds> m_failoverTimeout
+	{ DEFAULT_FAILOVER_TIMEOUT };
+	// IPv4 in network byte order -> priority, guarded by m_subscriptionMutex
+	std::unordered_map<uint32_t, uint8_t> m_sourcePriorities;
+	std::atomic<bool> m_outputMerging // Configured universe, for ArtPollReply
+	{ false };
+
+	// Held shared for a whole receive batch, exclusive to change
+	std::shared_mutex m_subscriptionMutex;
+	SubscriptionTable<Subscription> m_subscriptions;
+
+	void deliverDmx(Subscription &subscription, const uint8_t *data,
+			uint16_t length);
+
+	// Callback offload, configured while stopped
+	CallbackDispatcher m_dispatcher;
+	size_t m_dispatchWorkers = 0;
+	CallbackDispatcher::Policy m_dispatchPolicy =
+			CallbackDispatcher::Policy::Coalesce;
+	size_t m_dispatchRingSize = DEFAULT_DISPATCH_RING_SIZE;
+
+	void dispatchDmx(Subscription &subscription, const uint8_t *data,
+			uint16_t length);
+	void runDispatched(const CallbackDispatcher::Item &item);
+
+	bool startWorkers();
+	void stopWorkers();
+	void receiveBatch(ReceiveWorker &worker, size_t index);
+	size_t refillBuffers(ReceiveWorker &worker);
+	void handleArtPacket(const uint8_t *buffer, size_t size,
+			sockaddr_in senderAddr, const PacketPool::Ref &packet);
+
+	// Opcode handlers share one signature so they fit one dispatch table
+	using PacketHandler = void (ArtNetController::*)(const uint8_t *buffer,
+			size_t size, sockaddr_in senderAddr, const PacketPool::Ref &packet);
+	// Indexed by the OpCode high byte, every OpCode has a zero low byte
+	static const std::array<PacketHandler, 256> PACKET_HANDLERS;
+	// bench/parse_bench.cpp times the receive dispatch without sockets
+	friend struct ParseBench;
+
+	void handleArtDmx(const uint8_t *buffer, size_t size,
+			sockaddr_in senderAddr, const PacketPool::Ref &packet);
+	void handleArtSync(const uint8_t *buffer, size_t size,
+			sockaddr_in senderAddr, const PacketPool::Ref &packet);
+	void handleArtPoll(const uint8_t *buffer, size_t size,
+			sockaddr_in senderAddr, const PacketPool::Ref &packet);
+	void handleArtPollReply(const uint8_t *buffer, size_t size,
+			sockaddr_in senderAddr, const PacketPool::Ref &packet);
 
 	// Node Discovery
 	struct NodeInfo
@@ -153,14 +602,26 @@ private:
 		uint16_t oem;
 		uint8_t netSwitch;
 		uint8_t subSwitch;
+		uint8_t bindIndex;
+		Endpoint endpoint; // Where the reply came from, used for unicast
 		std::string shortName;
 		std::string longName;
 		std::vector<uint16_t> subscribedUniverses; // List of subscribed universes
-		// Add other useful information from the ArtPollReply
+		std::chrono::steady_clock::time_point lastSeen;
 	};
 
+	// Keyed by "address/bindIndex", one entry per bound device of a node
 	std::map<std::string, NodeInfo> m_discoveredNodes;
-	std::mutex m_nodesMutex;
+	// Universe -> unicast endpoints of its subscribers, built from the nodes
+	std::unordered_map<uint16_t, std::vector<Endpoint>> m_routes;
+	size_t m_maxUnicastNodes = DEFAULT_MAX_UNICAST_NODES;
+	std::mutex m_nodesMutex; // Lock after m_dataMutex when both are needed
+	// This host's IPv4 addresses, listed by start(). Our own ArtPoll and
+	// ArtPollReply come back from one of them and are ignored.
+	std::vector<uint32_t> m_localAddresses;
+
+	bool isLocalSender(const sockaddr_in &sender) const;
+	void rebuildRoutes();
 };
 
 } // namespace ArtNet
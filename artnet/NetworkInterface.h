@@ -1,33 +1,274 @@
 #pragma once
 
+#include <arpa/inet.h>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <netinet/in.h>
 #include <queue>
 #include <string>
+#include <sys/uio.h>
 #include <thread>
 #include <vector>
 
+#include "latency_histogram.h"
+
 namespace ArtNet
 {
+// IPv4 destination resolved once, so nothing is parsed on the send path
+struct Endpoint
+{
+	sockaddr_in address;
+
+	Endpoint() :
+			address()
+	{
+		address.sin_family = AF_INET;
+	}
+
+	explicit Endpoint(const sockaddr_in &addr) :
+			address(addr)
+	{
+	}
+
+	Endpoint(in_addr ip, int port) :
+			Endpoint()
+	{
+		address.sin_addr = ip;
+		address.sin_port = htons(static_cast<uint16_t>(port));
+	}
+
+	// Parses a dotted IPv4 address, returns false if it is not valid
+	static bool parse(const std::string &ip, int port, Endpoint &endpoint)
+	{
+		in_addr addr;
+		if (inet_pton(AF_INET, ip.c_str(), &addr) != 1)
+			return false;
+		endpoint = Endpoint(addr, port);
+		return true;
+	}
+
+	int port() const
+	{
+		return ntohs(address.sin_port);
+	}
+
+	bool operator==(const Endpoint &other) const
+	{
+		return address.sin_addr.s_addr == other.address.sin_addr.s_addr
+				&& address.sin_port == other.address.sin_port;
+	}
+};
+
+// One packet of a batch passed to sendPackets(). A packet is gathered from
+// up to MAX_SEGMENTS buffers (e.g. ArtDmx header + caller's payload) so it
+// never has to be concatenated in user space.
+struct OutgoingPacket
+{
+	static constexpr size_t MAX_SEGMENTS = 2;
+
+	std::array<iovec, MAX_SEGMENTS> segments;
+	size_t segmentCount;
+	Endpoint destination;
+
+	OutgoingPacket(const uint8_t *data, size_t size,
+			const Endpoint &destination) :
+			segments
+			{ { { const_cast<uint8_t*>(data), size } } }, segmentCount(1), destination(
+					destination)
+	{
+	}
+
+	OutgoingPacket(const uint8_t *header, size_t headerSize,
+			const uint8_t *payload, size_t payloadSize,
+			const Endpoint &destination) :
+			segments
+			{ { { const_cast<uint8_t*>(header), headerSize },
+					{ const_cast<uint8_t*>(payload), payloadSize } } }, segmentCount(
+					2), destination(destination)
+	{
+	}
+};
+
+// One slot of a receive batch. The caller provides the buffer, the
+// interface fills in size and sender.
+struct IncomingPacket
+{
+	uint8_t *data;
+	size_t capacity;
+	size_t size;
+	Endpoint sender;
+	// Kernel receive time (CLOCK_REALTIME), 0 without kernel timestamps
+	std::chrono::nanoseconds timestamp;
+};
+
+// Implementation the controller opens its sockets with
+enum class NetworkBackend
+{
+	Sockets, // sendmmsg()/recvmmsg() on Linux, sendto()/recvfrom() elsewhere
+	IoUring  // Linux 6.1+, Sockets where the kernel cannot set it up
+};
+
 // Abstract class for network interface ( platform agnostic )
 class NetworkInterface
 {
 public:
 	static constexpr size_t MAX_PACKET_SIZE = 2048;
 
+	struct SendStatistics
+	{
+		uint64_t packetsSent;
+		uint64_t sendCalls; // Number of send syscalls issued
+	};
+
+	struct ReceiveStatistics
+	{
+		uint64_t packetsReceived;
+		uint64_t receiveCalls; // Number of receive syscalls issued
+		uint64_t largestBatch; // Most datagrams returned by one call
+	};
+
 public:
 	virtual ~NetworkInterface() = default;
 	virtual bool createSocket(const std::string &bindAddress, int port) = 0;
 	virtual bool bindSocket() = 0;
-	virtual bool sendPacket(const std::vector<uint8_t> &packet,
-			const std::string &address, int port) = 0;
-	virtual int receivePacket(std::vector<uint8_t> &buffer) = 0;
+	// Sends one datagram gathered from `count` segments
+	virtual bool sendPacket(const iovec *segments, size_t count,
+			const Endpoint &destination) = 0;
+	// Sends a batch of packets using as few syscalls as the platform allows.
+	// Returns the number of packets sent. Any thread, also concurrently.
+	virtual size_t sendPackets(const OutgoingPacket *packets, size_t count) = 0;
+	// Receives one datagram into the caller's buffer. Returns its size, 0 if
+	// nothing arrived before the socket timeout or -1 on error (errno set).
+	virtual int receivePacket(uint8_t *buffer, size_t capacity,
+			Endpoint &sender) = 0;
+	// Receives up to `count` datagrams into the slots, blocking only for the
+	// first. Returns how many arrived, 0 on timeout or -1 on error (errno
+	// set). The default takes one datagram per call.
+	virtual int receivePackets(IncomingPacket *packets, size_t count)
+	{
+		if (count == 0)
+			return 0;
+
+		int size = receivePacket(packets[0].data, packets[0].capacity,
+				packets[0].sender);
+		m_receiveCalls++;
+		if (size <= 0)
+			return size;
+
+		packets[0].size = static_cast<size_t>(size);
+		packets[0].timestamp = std::chrono::nanoseconds(0);
+		recordReceiveBatch(1);
+		return 1;
+	}
 	virtual void closeSocket() = 0;
 	virtual int getSocket() const = 0; // Added getSocket
+	// Descriptor an event loop waits on until datagrams can be received
+	virtual int getReceiveHandle() const
+	{
+		return getSocket();
+	}
+	// Called on the receiving thread before it first waits on
+	// getReceiveHandle(); receive calls then stay on that thread
+	virtual void prepareReceive()
+	{
+	}
+	// Backend in use, after any fallback
+	virtual NetworkBackend getBackend() const
+	{
+		return NetworkBackend::Sockets;
+	}
+	// Asks the kernel to pace this socket to `bytesPerSecond` (0 removes the
+	// limit). Returns false where the platform has no socket pacing.
+	virtual bool setMaxPacingRate(uint64_t bytesPerSecond)
+	{
+		(void) bytesPerSecond;
+		return false;
+	}
+	// Spreads datagrams over the `workers` sockets bound to the same port
+	// (see receiveShard). Call on one socket once all are bound. Returns
+	// false where the kernel cannot steer them.
+	virtual bool attachReceiveSharding(size_t workers)
+	{
+		(void) workers;
+		return false;
+	}
+
+	// Software timestamps from the kernel: receivePackets() then fills in
+	// IncomingPacket::timestamp and, where supported, getSendDelay() tracks
+	// how long sent datagrams took to reach the driver. Call after
+	// createSocket(). Returns false where the platform has none.
+	virtual bool setKernelTimestamps(bool enable)
+	{
+		(void) enable;
+		return false;
+	}
+	virtual LatencyHistogram::Snapshot getSendDelay() const
+	{
+		return LatencyHistogram::Snapshot
+		{ };
+	}
+
+	// Lets several sockets bind the same port, set before createSocket()
+	void setReusePort(bool enable)
+	{
+		m_reusePort = enable;
+	}
+
+	// Receive calls return 0 at once instead of waiting for SO_RCVTIMEO,
+	// for sockets driven by an event loop. Sending still blocks.
+	void setNonBlockingReceive(bool enable)
+	{
+		m_nonBlockingReceive = enable;
+	}
+
+	bool sendPacket(const uint8_t *data, size_t size,
+			const Endpoint &destination)
+	{
+		iovec segment
+		{ const_cast<uint8_t*>(data), size };
+		return sendPacket(&segment, 1, destination);
+	}
+
+	SendStatistics getSendStatistics() const
+	{
+		return SendStatistics
+		{ m_packetsSent.load(), m_sendCalls.load() };
+	}
+
+	ReceiveStatistics getReceiveStatistics() const
+	{
+		return ReceiveStatistics
+		{ m_packetsReceived.load(), m_receiveCalls.load(),
+				m_largestReceiveBatch.load() };
+	}
+
+protected:
+	bool m_reusePort = false;
+	bool m_nonBlockingReceive = false;
+
+	// Called from the receiving thread only
+	void recordReceiveBatch(size_t count)
+	{
+		m_packetsReceived += count;
+		if (count > m_largestReceiveBatch.load(std::memory_order_relaxed))
+			m_largestReceiveBatch.store(count, std::memory_order_relaxed);
+	}
+
+	std::atomic<uint64_t> m_packetsSent
+	{ 0 };
+	std::atomic<uint64_t> m_sendCalls
+	{ 0 };
+	std::atomic<uint64_t> m_packetsReceived
+	{ 0 };
+	std::atomic<uint64_t> m_receiveCalls
+	{ 0 };
+	std::atomic<uint64_t> m_largestReceiveBatch
+	{ 0 };
 };
 
 } // namespace ArtNet
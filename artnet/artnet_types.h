@@ -2,6 +2,7 @@
 
 #include <arpa/inet.h>
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 // #include <vector>
@@ -14,6 +15,35 @@ constexpr uint16_t ARTNET_PORT = 6454;
 constexpr uint16_t ARTNET_FPS = 44;
 constexpr uint16_t ARTNET_HEADER_SIZE = 12;
 constexpr uint16_t ARTNET_MAX_DMX_SIZE = 512;
+constexpr uint16_t ARTDMX_HEADER_SIZE = 18; // ArtDmx fields before the data
+constexpr uint16_t ARTDMX_MIN_LENGTH = 2;   // Length is even, 2 to 512
+constexpr uint16_t ARTNET_PORT_ADDRESS_COUNT = 0x8000; // 15-bit Port-Address
+constexpr size_t CACHE_LINE_SIZE = 64;
+constexpr size_t ARTNET_OPCODE_OFFSET = 8;    // OpCode, low byte first
+constexpr size_t ARTDMX_UNIVERSE_OFFSET = 14; // SubUni, then Net
+
+// Port-Address = Net (7 bits) | Sub-Net (4 bits) | Universe (4 bits)
+inline uint16_t makePortAddress(uint8_t net, uint8_t subnet, uint8_t universe)
+{
+	return static_cast<uint16_t>(((net & 0x7F) << 8) | ((subnet & 0x0F) << 4)
+			| (universe & 0x0F));
+}
+
+// Receive worker that owns a datagram. ArtDmx is spread by Port-Address so
+// one universe always lands on the same worker, everything else goes to
+// worker 0. Must match the kernel filter in NetworkInterfaceLinux.
+inline size_t receiveShard(const uint8_t *buffer, size_t size, size_t workers)
+{
+	if (workers <= 1 || size < ARTDMX_UNIVERSE_OFFSET + 2
+			|| buffer[ARTNET_OPCODE_OFFSET] != 0x00
+			|| buffer[ARTNET_OPCODE_OFFSET + 1] != 0x50)
+		return 0;
+
+	uint16_t portAddress = static_cast<uint16_t>(
+			buffer[ARTDMX_UNIVERSE_OFFSET]
+					| (buffer[ARTDMX_UNIVERSE_OFFSET + 1] << 8));
+	return portAddress % workers;
+}
 
 // Op Codes (from spec table 1)
 #pragma pack(push, 1) // Disable padding.
@@ -147,9 +177,10 @@ struct ArtPollReplyPacket
 	std::array<uint8_t, 4> goodOutputA;
 	std::array<uint8_t, 4> swIn;
 	std::array<uint8_t, 4> swOut;
-	std::array<uint8_t, 4> acnPriority;
-	std::array<uint8_t, 4> swMacro;
-	std::array<uint8_t, 4> swRemote;
+	uint8_t acnPriority;
+	uint8_t swMacro;
+	uint8_t swRemote;
+	std::array<uint8_t, 3> spare;
 	uint8_t style;
 	std::array<uint8_t, 6> mac;
 	uint8_t bindIp[4];
@@ -158,10 +189,10 @@ struct ArtPollReplyPacket
 	std::array<uint8_t, 4> goodOutputB;
 	uint8_t status3;
 	std::array<uint8_t, 6> defaultResponder;
-	uint16_t userHi;
-	uint16_t userLo;
-	uint16_t refreshRateHi;
-	uint16_t refreshRateLo;
+	uint8_t userHi;
+	uint8_t userLo;
+	uint8_t refreshRateHi;
+	uint8_t refreshRateLo;
 	uint8_t backgroundQueuePolicy;
 	std::array<uint8_t, 10> filler; // This is field 54 (optional)
 
@@ -169,7 +200,9 @@ struct ArtPollReplyPacket
 			header(OpCode::OpPollReply), ip
 			{ 0 }, port(ARTNET_PORT), versionInfo
 			{ 0, 0 }, netSwitch(0), subSwitch(0), oem(0), ubeaVersion(0), status(
-					0), estaMan(0), numPorts(0), style(0), mac
+					0), estaMan(0), numPorts(0), acnPriority(0), swMacro(0), swRemote(
+					0), spare
+			{ 0 }, style(0), mac
 			{ 0 }, bindIp
 			{ 0 }, bindIndex(0), status2(0), goodOutputB
 			{ 0 }, status3(0), defaultResponder
@@ -185,12 +218,10 @@ struct ArtPollReplyPacket
 		goodInputA.fill(0);
 		swIn.fill(0);
 		swOut.fill(0);
-		acnPriority.fill(0);
-		swMacro.fill(0);
-		swRemote.fill(0);
 	}
 };
 #pragma pack(pop) // Restore default alignment.
+static_assert(sizeof(ArtPollReplyPacket) == 239, "ArtPollReply must be 239 bytes");
 //
 // ArtDmx Packet (from spec section 7.2)
 #pragma pack(push, 1) // Ensure proper packing
@@ -220,6 +251,24 @@ struct ArtDmxPacket
 };
 #pragma pack(pop) // Restore default packing (if not already present)
 
+// ArtSync Packet (from spec section 7.4)
+#pragma pack(push, 1) // Ensure proper packing
+struct ArtSyncPacket
+{
+	ArtHeader header;
+	uint8_t versionHi;  // Protocol version, high byte first
+	uint8_t versionLow; // Protocol version, low byte last
+	uint8_t aux1;       // Transmit as zero
+	uint8_t aux2;       // Transmit as zero
+
+	ArtSyncPacket() :
+			header(OpCode::OpSync), versionHi(0), versionLow(14), aux1(0), aux2(
+					0)
+	{
+	}
+};
+#pragma pack(pop) // Restore default packing (if not already present)
+
 // More packet definitions will follow, here is an example:
 #pragma pack(push, 1) // Ensure proper packing
 struct ArtTodDataPacket
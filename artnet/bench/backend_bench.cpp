@@ -0,0 +1,257 @@
+// Sends and receives ArtDmx batches over loopback through one network
+// backend and reports CPU time and syscalls per packet, to compare
+// sendmmsg()/recvmmsg() with io_uring on the same kernel.
+//
+//   artnet_bench_backend [sockets|io_uring]   (both when omitted)
+
+#include "../NetworkInterface.h"
+#include "../logging.h"
+#include "../network_interface_io_uring.h"
+#include "../network_interface_linux.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace ArtNet;
+
+static constexpr size_t BATCH = 64;
+static constexpr int ROUNDS = 20000;
+static constexpr int SEND_PORT = 16472;
+static constexpr int RECEIVE_PORT = 16473;
+
+static std::unique_ptr<NetworkInterface> createInterface(
+		NetworkBackend backend)
+{
+	if (backend == NetworkBackend::IoUring)
+		return std::make_unique<NetworkInterfaceIoUring>();
+	return std::make_unique<NetworkInterfaceLinux>();
+}
+
+static const char* backendName(NetworkBackend backend)
+{
+	return backend == NetworkBackend::IoUring ? "io_uring" : "sockets";
+}
+
+static double threadCpuSeconds()
+{
+	timespec now;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+	return static_cast<double>(now.tv_sec) + now.tv_nsec * 1e-9;
+}
+
+static std::unique_ptr<NetworkInterface> openInterface(NetworkBackend backend,
+		int port)
+{
+	std::unique_ptr<NetworkInterface> networkInterface = createInterface(
+			backend);
+	if (!networkInterface->createSocket("127.0.0.1", port)
+			|| !networkInterface->bindSocket())
+		return nullptr;
+
+	// Loopback drops what the receiver has not read yet
+	int size = 64 << 20;
+	setsockopt(networkInterface->getSocket(), SOL_SOCKET, SO_RCVBUFFORCE,
+			&size, sizeof(size));
+	return networkInterface;
+}
+
+// Receive slots over one contiguous buffer
+struct ReceiveSlots
+{
+	std::vector<uint8_t> buffer;
+	std::vector<IncomingPacket> slots;
+
+	ReceiveSlots() :
+			buffer(BATCH * NetworkInterface::MAX_PACKET_SIZE), slots(BATCH)
+	{
+		for (size_t i = 0; i < BATCH; i++)
+		{
+			slots[i] = IncomingPacket
+			{ &buffer[i * NetworkInterface::MAX_PACKET_SIZE],
+					NetworkInterface::MAX_PACKET_SIZE, 0, Endpoint(),
+					std::chrono::nanoseconds(0) };
+		}
+	}
+};
+
+// One batch of full ArtDmx packets, header and payload gathered
+struct SendBatch
+{
+	uint8_t header[ARTDMX_HEADER_SIZE];
+	uint8_t payload[ARTNET_MAX_DMX_SIZE];
+	std::vector<OutgoingPacket> packets;
+
+	explicit SendBatch(const Endpoint &destination)
+	{
+		std::memset(header, 0, sizeof(header));
+		std::memcpy(header, "Art-Net", 8);
+		header[ARTNET_OPCODE_OFFSET + 1] = 0x50;
+		std::memset(payload, 0xFF, sizeof(payload));
+		for (size_t i = 0; i < BATCH; i++)
+		{
+			packets.emplace_back(header, sizeof(header), payload,
+					sizeof(payload), destination);
+		}
+	}
+};
+
+// The backend sends, a sockets receiver drains
+static bool benchSend(NetworkBackend backend)
+{
+	std::unique_ptr<NetworkInterface> receiver = openInterface(
+			NetworkBackend::Sockets, SEND_PORT);
+	std::unique_ptr<NetworkInterface> sender = openInterface(backend, 0);
+	if (!receiver || !sender)
+		return false;
+
+	std::atomic<bool> stop
+	{ false };
+	std::atomic<uint64_t> received
+	{ 0 };
+	std::thread drain([&]()
+	{
+		ReceiveSlots slots;
+		receiver->setNonBlockingReceive(true);
+		while (!stop)
+		{
+			int count = receiver->receivePackets(slots.slots.data(), BATCH);
+			if (count > 0)
+				received += static_cast<uint64_t>(count);
+		}
+	});
+
+	Endpoint destination;
+	Endpoint::parse("127.0.0.1", SEND_PORT, destination);
+	SendBatch batch(destination);
+
+	size_t sent = 0;
+	double cpu = threadCpuSeconds();
+	for (int i = 0; i < ROUNDS; i++)
+	{
+		sent += sender->sendPackets(batch.packets.data(), BATCH);
+		// Lets the receiver keep up, loopback has no wire to pace it
+		if (i % 8 == 7)
+			usleep(50);
+	}
+	cpu = threadCpuSeconds() - cpu;
+
+	usleep(200000);
+	stop = true;
+	drain.join();
+
+	NetworkInterface::SendStatistics statistics = sender->getSendStatistics();
+	std::printf("%-8s send:    %zu packets, %.0f ns CPU/packet, "
+			"%.2f syscalls/batch, %llu received\n",
+			backendName(sender->getBackend()), sent,
+			sent > 0 ? cpu * 1e9 / static_cast<double>(sent) : 0.0,
+			static_cast<double>(statistics.sendCalls) / ROUNDS,
+			static_cast<unsigned long long>(received.load()));
+	return sent == BATCH * ROUNDS;
+}
+
+// A sockets sender feeds, the backend receives from an epoll loop as the
+// controller's workers do
+static bool benchReceive(NetworkBackend backend)
+{
+	std::unique_ptr<NetworkInterface> receiver = openInterface(backend,
+			RECEIVE_PORT);
+	std::unique_ptr<NetworkInterface> sender = openInterface(
+			NetworkBackend::Sockets, 0);
+	if (!receiver || !sender)
+		return false;
+	receiver->setNonBlockingReceive(true);
+
+	std::atomic<bool> stop
+	{ false };
+	uint64_t received = 0;
+	uint64_t wakeups = 0;
+	double cpu = 0;
+	std::thread receive([&]()
+	{
+		receiver->prepareReceive();
+		int epollFd = epoll_create1(EPOLL_CLOEXEC);
+		epoll_event event
+		{ };
+		event.events = EPOLLIN;
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, receiver->getReceiveHandle(), &event);
+
+		ReceiveSlots slots;
+		double start = threadCpuSeconds();
+		while (!stop)
+		{
+			if (epoll_wait(epollFd, &event, 1, 50) <= 0)
+				continue;
+			wakeups++;
+			int count = receiver->receivePackets(slots.slots.data(), BATCH);
+			if (count > 0)
+				received += static_cast<uint64_t>(count);
+		}
+		cpu = threadCpuSeconds() - start;
+		close(epollFd);
+	});
+	usleep(50000);
+
+	Endpoint destination;
+	Endpoint::parse("127.0.0.1", RECEIVE_PORT, destination);
+	SendBatch batch(destination);
+
+	size_t sent = 0;
+	for (int i = 0; i < ROUNDS; i++)
+	{
+		sent += sender->sendPackets(batch.packets.data(), BATCH);
+		usleep(20);
+	}
+
+	usleep(200000);
+	stop = true;
+	receive.join();
+
+	NetworkInterface::ReceiveStatistics statistics =
+			receiver->getReceiveStatistics();
+	double packets = received > 0 ? static_cast<double>(received) : 1.0;
+	std::printf("%-8s receive: %llu of %zu packets, %.0f ns CPU/packet, "
+			"%.3f syscalls/packet, %.3f wakeups/packet\n",
+			backendName(receiver->getBackend()),
+			static_cast<unsigned long long>(received), sent,
+			cpu * 1e9 / packets,
+			static_cast<double>(statistics.receiveCalls) / packets,
+			static_cast<double>(wakeups) / packets);
+	return received > 0;
+}
+
+int main(int argc, char *argv[])
+{
+	Logger::setLevel(LogLevel::ERROR);
+
+	std::vector<NetworkBackend> backends;
+	if (argc < 2 || std::strcmp(argv[1], "sockets") == 0)
+		backends.push_back(NetworkBackend::Sockets);
+	if (argc < 2 || std::strcmp(argv[1], "io_uring") == 0)
+		backends.push_back(NetworkBackend::IoUring);
+	if (backends.empty())
+	{
+		std::fprintf(stderr, "Usage: %s [sockets|io_uring]\n", argv[0]);
+		return 2;
+	}
+
+	bool ok = true;
+	for (NetworkBackend backend : backends)
+	{
+		ok = benchSend(backend) && ok;
+	}
+	for (NetworkBackend backend : backends)
+	{
+		ok = benchReceive(backend) && ok;
+	}
+	return ok ? 0 : 1;
+}
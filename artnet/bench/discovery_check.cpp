@@ -0,0 +1,89 @@
+// Polls over loopback, where the controller hears its own ArtPoll and
+// would answer it, and checks that it does not discover itself: the route
+// table must stay empty so its universes keep being broadcast. A reply
+// from another address on the loopback network must still be routed.
+
+#include "../ArtNetController.h"
+#include "../logging.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+static constexpr int PORT = 16474;
+
+// ArtPollReply of a one-port node outputting `universe`, sent from
+// `address` (127.0.0.2 is loopback but not an interface address)
+static bool sendNodeReply(const char *address, uint8_t universe)
+{
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd == -1)
+		return false;
+
+	sockaddr_in source
+	{ };
+	source.sin_family = AF_INET;
+	inet_pton(AF_INET, address, &source.sin_addr);
+	sockaddr_in destination
+	{ };
+	destination.sin_family = AF_INET;
+	destination.sin_port = htons(PORT);
+	inet_pton(AF_INET, "127.0.0.1", &destination.sin_addr);
+
+	ArtNet::ArtPollReplyPacket reply;
+	reply.numPorts = htons(1);
+	reply.portType[0] = 0x80; // Output
+	reply.swOut[0] = universe;
+
+	bool sent = bind(fd, reinterpret_cast<sockaddr*>(&source), sizeof(source))
+			== 0
+			&& sendto(fd, &reply, sizeof(reply), 0,
+					reinterpret_cast<sockaddr*>(&destination),
+					sizeof(destination)) == sizeof(reply);
+	close(fd);
+	return sent;
+}
+
+int main()
+{
+	ArtNet::Logger::setLevel(ArtNet::LogLevel::ERROR);
+
+	// The "broadcast" address is our own, so the poll comes straight back
+	ArtNet::ArtNetController controller;
+	controller.setEnableDiscovery(true);
+	if (!controller.configure("127.0.0.1", PORT, 0, 0, 1, "127.0.0.1")
+			|| !controller.start())
+	{
+		std::fprintf(stderr, "Failed to start the controller\n");
+		return 1;
+	}
+
+	// start() has polled, give the round-trip time to come back
+	controller.sendPoll();
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	ArtNet::ArtNetController::Statistics::Snapshot own =
+			controller.getStatistics();
+
+	bool replied = sendNodeReply("127.0.0.2", 1);
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	ArtNet::ArtNetController::Statistics::Snapshot other =
+			controller.getStatistics();
+	controller.stop();
+
+	std::printf("After our own poll: %llu node(s), %llu routed universe(s)\n",
+			static_cast<unsigned long long>(own.discoveredNodes),
+			static_cast<unsigned long long>(own.routedUniverses));
+	std::printf("After a reply from 127.0.0.2: %llu node(s), "
+			"%llu routed universe(s)\n",
+			static_cast<unsigned long long>(other.discoveredNodes),
+			static_cast<unsigned long long>(other.routedUniverses));
+
+	bool ok = own.discoveredNodes == 0 && own.routedUniverses == 0
+			&& replied && other.discoveredNodes == 1
+			&& other.routedUniverses == 1;
+	std::printf("%s\n", ok ? "OK" : "FAILED");
+	return ok ? 0 : 1;
+}
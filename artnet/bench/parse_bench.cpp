@@ -0,0 +1,154 @@
+// Times what a received ArtDmx costs before any subscription work: the
+// Art-Net ID check, the opcode dispatch and the ArtDmx parse. The current
+// path (hasArtNetId(), PACKET_HANDLERS, ArtDmxView) is compared with the
+// strncmp() and if/else chain it replaced, and with the controller's own
+// handleArtPacket() for a universe nobody subscribed to.
+
+#include "../ArtNetController.h"
+#include "../logging.h"
+#include "../packet_view.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static constexpr int ROUNDS = 10000000;
+
+namespace ArtNet
+{
+
+struct ParseBench
+{
+	// hasArtNetId() + PACKET_HANDLERS + ArtDmxView, as handleArtPacket()
+	// and handleArtDmx() do it
+	static uint16_t currentPath(const uint8_t *buffer, size_t size)
+	{
+		if (!hasArtNetId(buffer, size))
+			return 0;
+		uint16_t opcode = readOpcode(buffer);
+		ArtNetController::PacketHandler handler =
+				(opcode & 0xFF) == 0 ?
+						ArtNetController::PACKET_HANDLERS[opcode >> 8] :
+						nullptr;
+		if (handler != &ArtNetController::handleArtDmx)
+			return 0;
+
+		ArtDmxView dmx;
+		if (!dmx.parse(buffer, size))
+			return 0;
+		return static_cast<uint16_t>(dmx.portAddress() + dmx.length());
+	}
+
+	static void handleArtPacket(ArtNetController &controller,
+			const uint8_t *buffer, size_t size, sockaddr_in sender,
+			const PacketPool::Ref &packet)
+	{
+		controller.handleArtPacket(buffer, size, sender, packet);
+	}
+};
+
+} // namespace ArtNet
+
+// The receive path before the packet views: strncmp() on the ID, an
+// if/else chain on the OpCode and a cast to ArtDmxPacket
+static uint16_t previousPath(const uint8_t *buffer, size_t size)
+{
+	using namespace ArtNet;
+
+	if (size < ARTNET_HEADER_SIZE)
+		return 0;
+	const ArtHeader *header = reinterpret_cast<const ArtHeader*>(buffer);
+	if (std::strncmp(reinterpret_cast<const char*>(header->id.data()),
+			"Art-Net", 8) != 0)
+		return 0;
+	uint16_t opcode = header->opcode;
+
+	if (opcode == static_cast<uint16_t>(OpCode::OpDmx))
+	{
+		if (Logger::getLevel() >= LogLevel::DEBUG)
+			Logger::debug("handleArtPacket opcode: OpDmx ", opcode);
+		if (size < ARTNET_HEADER_SIZE + 4)
+			return 0;
+
+		const ArtDmxPacket *dmxPacket =
+				reinterpret_cast<const ArtDmxPacket*>(buffer);
+		const uint8_t *address =
+				reinterpret_cast<const uint8_t*>(&dmxPacket->universe);
+		uint16_t packetUniverse = static_cast<uint16_t>(address[0]
+				| ((address[1] & 0x7F) << 8));
+		uint16_t dmxLength = ntohs(dmxPacket->length);
+		if (dmxLength > ARTNET_MAX_DMX_SIZE
+				|| static_cast<size_t>(ARTDMX_HEADER_SIZE + dmxLength) > size)
+			return 0;
+		return static_cast<uint16_t>(packetUniverse + dmxLength);
+	}
+	else if (opcode == static_cast<uint16_t>(OpCode::OpPoll))
+		return 1;
+	else if (opcode == static_cast<uint16_t>(OpCode::OpPollReply))
+		return 2;
+	else if (opcode == static_cast<uint16_t>(OpCode::OpSync))
+		return 3;
+	return 0;
+}
+
+template<typename Parse>
+static double timePerPacket(std::vector<uint8_t> &datagram, Parse parse)
+{
+	using Clock = std::chrono::steady_clock;
+	uint32_t sink = 0;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < ROUNDS; i++)
+	{
+		// A new sequence and universe every packet, as on the wire
+		datagram[ArtNet::ArtDmxView::SEQUENCE_OFFSET] = static_cast<uint8_t>(i);
+		datagram[ArtNet::ARTDMX_UNIVERSE_OFFSET] = static_cast<uint8_t>(i >> 8);
+		asm volatile("" : : "r"(datagram.data()) : "memory");
+		sink += parse(datagram.data(), datagram.size());
+	}
+	double ns = std::chrono::duration<double, std::nano>(
+			Clock::now() - start).count() / ROUNDS;
+	asm volatile("" : : "r"(sink));
+	return ns;
+}
+
+int main()
+{
+	ArtNet::Logger::setLevel(ArtNet::LogLevel::ERROR);
+
+	std::vector<uint8_t> datagram(ArtNet::ARTDMX_HEADER_SIZE
+			+ ArtNet::ARTNET_MAX_DMX_SIZE);
+	std::memcpy(datagram.data(), "Art-Net", 8);
+	datagram[ArtNet::ARTNET_OPCODE_OFFSET + 1] = 0x50; // OpDmx
+	datagram[11] = 14; // ProtVer
+	datagram[ArtNet::ARTDMX_UNIVERSE_OFFSET + 1] = 0x40; // Net 64, unsubscribed
+	datagram[ArtNet::ArtDmxView::LENGTH_OFFSET] = 0x02; // 512
+
+	double current = timePerPacket(datagram, ArtNet::ParseBench::currentPath);
+	double previous = timePerPacket(datagram, previousPath);
+
+	ArtNet::ArtNetController controller;
+	sockaddr_in sender
+	{ };
+	sender.sin_family = AF_INET;
+	sender.sin_addr.s_addr = htonl(0x7F000001);
+	ArtNet::PacketPool::Ref packet;
+	double controllerNs = timePerPacket(datagram,
+			[&](const uint8_t *buffer, size_t size)
+			{
+				ArtNet::ParseBench::handleArtPacket(controller, buffer, size,
+						sender, packet);
+				return 0;
+			});
+
+	std::printf("ArtDmx ID check, dispatch and parse, per packet:\n");
+	std::printf("  hasArtNetId + PACKET_HANDLERS + ArtDmxView: %.1f ns\n",
+			current);
+	std::printf("  strncmp + if/else + ArtDmxPacket cast:      %.1f ns\n",
+			previous);
+	std::printf("  handleArtPacket(), unsubscribed universe:   %.1f ns\n",
+			controllerNs);
+	return 0;
+}
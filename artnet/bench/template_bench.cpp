@@ -0,0 +1,107 @@
+// Counts heap allocations on the sending thread and times setDmxData()
+// against a plain 512-byte memcpy. With packet templates a steady-state
+// frame must not allocate, and setDmxData() is one copy into the payload.
+
+#include "../ArtNetController.h"
+#include "../logging.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+static thread_local bool t_counting = false;
+static thread_local uint64_t t_allocations = 0;
+
+void* operator new(size_t size)
+{
+	if (t_counting)
+		t_allocations++;
+	if (void *memory = std::malloc(size ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+static constexpr uint16_t UNIVERSES = 256;
+static constexpr int FRAMES = 200;
+static constexpr int COPY_ROUNDS = 200000;
+
+int main()
+{
+	ArtNet::Logger::setLevel(ArtNet::LogLevel::ERROR);
+
+	ArtNet::ArtNetController controller;
+	if (!controller.configure("127.0.0.1", 16470, 0, 0, 0, "127.0.0.1")
+			|| !controller.start())
+	{
+		std::fprintf(stderr, "Failed to start the controller\n");
+		return 1;
+	}
+	controller.setEnableSendingDMX(true);
+
+	std::vector<uint8_t> frame(ArtNet::ARTNET_MAX_DMX_SIZE);
+
+	// The first frame creates every universe's template
+	for (uint16_t universe = 0; universe < UNIVERSES; universe++)
+	{
+		controller.setDmxData(universe, frame.data(), frame.size());
+	}
+	controller.sendDmx();
+
+	t_counting = true;
+	for (int i = 0; i < FRAMES; i++)
+	{
+		frame[0] = static_cast<uint8_t>(i);
+		for (uint16_t universe = 0; universe < UNIVERSES; universe++)
+		{
+			controller.setDmxData(universe, frame.data(), frame.size());
+		}
+		controller.sendDmx();
+	}
+	t_counting = false;
+	uint64_t allocations = t_allocations;
+
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < COPY_ROUNDS; i++)
+	{
+		frame[0] = static_cast<uint8_t>(i);
+		controller.setDmxData(static_cast<uint16_t>(i % UNIVERSES),
+				frame.data(), frame.size());
+	}
+	double setNs = std::chrono::duration<double, std::nano>(
+			Clock::now() - start).count() / COPY_ROUNDS;
+
+	std::vector<uint8_t> target(ArtNet::ARTNET_MAX_DMX_SIZE);
+	start = Clock::now();
+	for (int i = 0; i < COPY_ROUNDS; i++)
+	{
+		frame[0] = static_cast<uint8_t>(i);
+		std::memcpy(target.data(), frame.data(), frame.size());
+		asm volatile("" : : "r"(target.data()) : "memory");
+	}
+	double copyNs = std::chrono::duration<double, std::nano>(
+			Clock::now() - start).count() / COPY_ROUNDS;
+
+	controller.stop();
+
+	std::printf("%d frames x %u universes: %llu allocation(s) on the "
+			"sending thread\n", FRAMES, UNIVERSES,
+			static_cast<unsigned long long>(allocations));
+	std::printf("setDmxData(512): %.1f ns, plain memcpy(512): %.1f ns\n",
+			setNs, copyNs);
+	return allocations == 0 ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+#include "callback_dispatcher.h"
+#include "logging.h"
+
+#include <cstring>
+
+namespace ArtNet
+{
+
+CallbackDispatcher::~CallbackDispatcher()
+{
+	stop();
+}
+
+bool CallbackDispatcher::start(size_t producers, size_t workers,
+		size_t ringCapacity, Handler handler)
+{
+	if (m_running)
+	{
+		Logger::error("Callback dispatcher already running");
+		return false;
+	}
+	if (producers == 0 || workers == 0 || workers > MAX_WORKERS
+			|| ringCapacity == 0 || !handler)
+	{
+		Logger::error("Invalid callback dispatcher configuration");
+		return false;
+	}
+
+	m_handler = std::move(handler);
+	m_producers = producers;
+	m_stopRequested = false;
+	m_rings.clear();
+	m_workers.clear();
+
+	for (size_t i = 0; i < producers * workers; i++)
+	{
+		m_rings.push_back(std::make_unique<Ring>(ringCapacity));
+	}
+	for (size_t index = 0; index < workers; index++)
+	{
+		auto worker = std::make_unique<Worker>();
+		for (size_t producer = 0; producer < producers; producer++)
+		{
+			worker->rings.push_back(m_rings[producer * workers + index].get());
+		}
+		m_workers.push_back(std::move(worker));
+	}
+
+	for (auto &worker : m_workers)
+	{
+		Worker *state = worker.get();
+		worker->thread = std::thread([this, state]()
+		{
+			run(*state);
+		});
+	}
+
+	m_running = true;
+	Logger::info("Callback dispatcher started with ", workers,
+			" worker(s), ring size ", m_rings.front()->queue.capacity());
+	return true;
+}
+
+void CallbackDispatcher::stop()
+{
+	if (!m_running)
+		return;
+
+	m_running = false;
+	m_stopRequested = true;
+	for (auto &worker : m_workers)
+	{
+		wake(*worker);
+	}
+	for (auto &worker : m_workers)
+	{
+		if (worker->thread.joinable())
+		{
+			worker->thread.join();
+		}
+	}
+}
+
+bool CallbackDispatcher::push(size_t producer, uint16_t universe,
+		const uint8_t *data, uint16_t length)
+{
+	size_t index = universe % m_workers.size();
+	Ring &ring = *m_rings[(producer % m_producers) * m_workers.size() + index];
+
+	Item *item = ring.queue.prepare();
+	if (!item)
+	{
+		ring.dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	item->universe = universe;
+	item->length = length;
+	if (length > 0)
+	{
+		std::memcpy(item->data.data(), data, length);
+	}
+	ring.queue.commit();
+
+	ring.pushed.fetch_add(1, std::memory_order_relaxed);
+	size_t occupancy = ring.queue.size();
+	if (occupancy > ring.highWater.load(std::memory_order_relaxed))
+	{
+		ring.highWater.store(occupancy, std::memory_order_relaxed);
+	}
+
+	// Pairs with the fence in run(): either the worker sees the item or
+	// we see it going to sleep
+	Worker &worker = *m_workers[index];
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (worker.sleeping.load(std::memory_order_relaxed))
+	{
+		wake(worker);
+	}
+	return true;
+}
+
+std::vector<CallbackDispatcher::RingStatistics> CallbackDispatcher::getStatistics() const
+{
+	std::vector<RingStatistics> statistics;
+	size_t workers = m_workers.size();
+	for (size_t i = 0; i < m_rings.size(); i++)
+	{
+		const Ring &ring = *m_rings[i];
+		statistics.push_back(
+		{ i / workers, i % workers, ring.queue.capacity(), ring.queue.size(),
+				ring.highWater.load(), ring.pushed.load(), ring.dropped.load() });
+	}
+	return statistics;
+}
+
+void CallbackDispatcher::run(Worker &worker)
+{
+	while (true)
+	{
+		if (drain(worker))
+			continue;
+		if (m_stopRequested)
+			return;
+
+		std::unique_lock<std::mutex> lock(worker.mutex);
+		worker.sleeping.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!pending(worker))
+		{
+			worker.wakeup.wait(lock, [&]()
+			{
+				return worker.woken || m_stopRequested;
+			});
+		}
+		worker.woken = false;
+		worker.sleeping.store(false, std::memory_order_relaxed);
+	}
+}
+
+bool CallbackDispatcher::drain(Worker &worker)
+{
+	bool delivered = false;
+	for (Ring *ring : worker.rings)
+	{
+		// At most one ring's worth at a time, so no producer starves the rest
+		for (size_t i = ring->queue.capacity(); i > 0; i--)
+		{
+			const Item *item = ring->queue.front();
+			if (!item)
+				break;
+			m_handler(*item);
+			ring->queue.pop();
+			delivered = true;
+		}
+	}
+	return delivered;
+}
+
+bool CallbackDispatcher::pending(const Worker &worker) const
+{
+	for (const Ring *ring : worker.rings)
+	{
+		if (ring->queue.size() > 0)
+			return true;
+	}
+	return false;
+}
+
+void CallbackDispatcher::wake(Worker &worker)
+{
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	worker.woken = true;
+	worker.wakeup.notify_one();
+}
+
+} // namespace ArtNet
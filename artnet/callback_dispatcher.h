@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "artnet_types.h"
+#include "spsc_ring.h"
+
+namespace ArtNet
+{
+
+// Runs receive callbacks on a pool of worker threads so a slow consumer
+// does not hold up the sockets. Every producer (receive worker) has one
+// SPSC ring per dispatch worker, and a universe always goes to the same
+// dispatch worker, so its frames stay in order. Rings are allocated by
+// start(); pushing copies into a ring slot and never allocates or locks
+// unless the worker has to be woken.
+class CallbackDispatcher
+{
+public:
+	// What happens to frames the workers have not caught up with
+	enum class Policy
+	{
+		Coalesce, // Only the newest frame per universe is delivered
+		Drop      // Every frame is queued, new ones are dropped when full
+	};
+
+	struct Item
+	{
+		uint16_t universe;
+		uint16_t length; // 0: notification only, the data is elsewhere
+		std::array<uint8_t, ARTNET_MAX_DMX_SIZE> data;
+	};
+	using Handler = std::function<void(const Item &item)>;
+
+	struct RingStatistics
+	{
+		size_t producer;
+		size_t worker;
+		size_t capacity;
+		size_t occupancy;
+		size_t highWater;
+		uint64_t pushed;
+		uint64_t dropped;
+	};
+
+	static constexpr size_t MAX_WORKERS = 16;
+
+	CallbackDispatcher() = default;
+	~CallbackDispatcher();
+
+	CallbackDispatcher(const CallbackDispatcher&) = delete;
+	CallbackDispatcher& operator=(const CallbackDispatcher&) = delete;
+
+	bool start(size_t producers, size_t workers, size_t ringCapacity,
+			Handler handler);
+	// Delivers what is still queued, then joins the workers
+	void stop();
+	bool isRunning() const
+	{
+		return m_running.load(std::memory_order_relaxed);
+	}
+
+	// Producer side, one thread per producer index. Returns false when the
+	// ring is full and the item was dropped.
+	bool push(size_t producer, uint16_t universe, const uint8_t *data,
+			uint16_t length);
+
+	// Stays readable after stop(), not safe against a concurrent start()
+	std::vector<RingStatistics> getStatistics() const;
+
+private:
+	struct Ring
+	{
+		explicit Ring(size_t capacity) :
+				queue(capacity)
+		{
+		}
+
+		SpscRing<Item> queue;
+		std::atomic<size_t> highWater
+		{ 0 };
+		std::atomic<uint64_t> pushed
+		{ 0 };
+		std::atomic<uint64_t> dropped
+		{ 0 };
+	};
+
+	struct Worker
+	{
+		std::vector<Ring*> rings; // One per producer
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable wakeup;
+		bool woken = false; // Guarded by mutex
+		std::atomic<bool> sleeping
+		{ false };
+	};
+
+	void run(Worker &worker);
+	bool drain(Worker &worker);
+	bool pending(const Worker &worker) const;
+	void wake(Worker &worker);
+
+	Handler m_handler;
+	size_t m_producers = 0;
+	std::vector<std::unique_ptr<Ring>> m_rings; // producer * workers + worker
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::atomic<bool> m_running
+	{ false };
+	std::atomic<bool> m_stopRequested
+	{ false };
+};
+
+} // namespace ArtNet
@@ -0,0 +1,187 @@
+#include "dmx_merger.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ArtNet
+{
+
+DmxMerger::Source* DmxMerger::acquireSource(uint32_t ip, uint8_t physical,
+		size_t maxSources, bool &isNew)
+{
+	Source *freeSlot = nullptr;
+	for (Source &source : m_sources)
+	{
+		if (!source.active)
+		{
+			if (!freeSlot)
+				freeSlot = &source;
+		}
+		else if (source.ip == ip && source.physical == physical)
+		{
+			isNew = false;
+			return &source;
+		}
+	}
+
+	// Further sources are ignored until one of the merged ones times out
+	if (!freeSlot || m_activeSources >= maxSources)
+		return nullptr;
+
+	freeSlot->ip = ip;
+	freeSlot->physical = physical;
+	freeSlot->active = true;
+	freeSlot->sequence = 0;
+	freeSlot->reorderedInARow = 0;
+	freeSlot->length = 0;
+	m_activeSources++;
+	isNew = true;
+	return freeSlot;
+}
+
+DmxMerger::Status DmxMerger::checkSequence(Source &source, uint8_t sequence,
+		Clock::time_point now, uint8_t &lost)
+{
+	lost = 0;
+	if (sequence == 0 || source.sequence == 0
+			|| now - source.lastSeen > SEQUENCE_RESYNC)
+	{
+		source.sequence = sequence;
+		source.reorderedInARow = 0;
+		return Status::Output;
+	}
+
+	// Sequence runs 1..255 and wraps to 1, so distances are modulo 255.
+	// Up to half the range ahead is new, the rest is behind.
+	unsigned distance = (sequence + 255u - source.sequence) % 255u;
+	if (distance == 0)
+		return Status::Duplicate;
+
+	if (distance > 127 && ++source.reorderedInARow < MAX_REORDERED_IN_A_ROW)
+		return Status::Reordered;
+
+	if (distance <= 127)
+		lost = static_cast<uint8_t>(distance - 1);
+	source.sequence = sequence;
+	source.reorderedInARow = 0;
+	return Status::Output;
+}
+
+bool DmxMerger::isMerged(const Source &source, uint8_t priority,
+		const Settings &settings, Clock::time_point now)
+{
+	return source.active && source.priority == priority
+			&& now - source.lastSeen <= settings.failoverTimeout;
+}
+
+DmxMerger::Result DmxMerger::merge(uint32_t ip, uint8_t physical,
+		uint8_t priority, uint8_t sequence, const uint8_t *data,
+		uint16_t length, const Settings &settings, Clock::time_point now)
+{
+	for (Source &source : m_sources)
+	{
+		if (source.active && now - source.lastSeen > SOURCE_TIMEOUT)
+		{
+			source.active = false;
+			m_activeSources--;
+		}
+	}
+
+	bool isNew = false;
+	Source *source = acquireSource(ip, physical, settings.maxSources, isNew);
+	if (!source)
+		return Result
+		{ Status::SourceRejected, nullptr, 0, 0, Switch::None };
+	source->priority = priority;
+
+	uint8_t lost = 0;
+	Status status = checkSequence(*source, sequence, now, lost);
+	source->lastSeen = now;
+	if (status != Status::Output)
+		return Result
+		{ status, nullptr, 0, 0, Switch::None };
+
+	// The highest priority still heard from within the failover timeout
+	// drives the output, this packet's source is live by definition
+	int livePriority = priority;
+	for (const Source &other : m_sources)
+	{
+		if (other.active && now - other.lastSeen <= settings.failoverTimeout)
+			livePriority = std::max<int>(livePriority, other.priority);
+	}
+	if (priority < livePriority)
+	{
+		// Kept current so a failover starts from this source's latest data
+		std::memcpy(source->data.data(), data, length);
+		source->length = length;
+		return Result
+		{ Status::Standby, nullptr, 0, lost, Switch::None };
+	}
+
+	Switch sourceSwitch = Switch::None;
+	if (m_outputPriority >= 0 && priority != m_outputPriority)
+	{
+		sourceSwitch =
+				priority < m_outputPriority ? Switch::Failover : Switch::Recovery;
+	}
+	m_outputPriority = priority;
+
+	m_mergingSources = 0;
+	for (const Source &other : m_sources)
+	{
+		if (isMerged(other, priority, settings, now))
+			m_mergingSources++;
+	}
+
+	if (m_mergingSources == 1)
+	{
+		// Nothing to merge; the output is kept in step for a later LTP merge
+		std::memcpy(source->data.data(), data, length);
+		source->length = length;
+		std::memcpy(m_output.data(), data, length);
+		m_outputLength = length;
+		return Result
+		{ Status::Output, data, length, lost, sourceSwitch };
+	}
+
+	if (settings.mode == Mode::LTP)
+	{
+		// Channels this source changed win. Its first packet, or the first
+		// after a switch of priority level, counts as changing all of them.
+		uint16_t known =
+				isNew || sourceSwitch != Switch::None ?
+						0 : std::min(length, source->length);
+		utils::copyChanged(m_output.data(), source->data.data(), data, known);
+		std::memcpy(m_output.data() + known, data + known, length - known);
+		m_outputLength = std::max(m_outputLength, length);
+
+		std::memcpy(source->data.data(), data, length);
+		source->length = length;
+	}
+	else
+	{
+		std::memcpy(source->data.data(), data, length);
+		source->length = length;
+
+		// Channels past a source's length count as zero
+		m_outputLength = 0;
+		for (const Source &other : m_sources)
+		{
+			if (isMerged(other, priority, settings, now))
+				m_outputLength = std::max(m_outputLength, other.length);
+		}
+		std::memset(m_output.data(), 0, m_outputLength);
+		for (const Source &other : m_sources)
+		{
+			if (isMerged(other, priority, settings, now))
+				utils::maxBytes(m_output.data(), other.data.data(),
+						other.length);
+		}
+	}
+
+	return Result
+	{ Status::Output, m_output.data(), m_outputLength, lost, sourceSwitch };
+}
+
+} // namespace ArtNet
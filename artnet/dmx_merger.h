@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "artnet_types.h"
+
+namespace ArtNet
+{
+
+// Merges ArtDmx from several sources sending to one universe, as the
+// Art-Net 4 node rules require. Sources are told apart by IP and physical
+// port and are forgotten after SOURCE_TIMEOUT of silence. Each source's
+// sequence numbers are tracked so late and repeated packets are dropped.
+// Only the highest-priority sources heard within the failover timeout are
+// merged; lower ones are kept on standby and take over when those go
+// silent. All buffers are fixed, merging never allocates. Used by one
+// thread at a time.
+class DmxMerger
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum class Mode
+	{
+		HTP, // Highest takes precedence, per channel
+		LTP  // Latest change takes precedence, per channel
+	};
+
+	enum class Status
+	{
+		Output,         // `data` holds what to output
+		SourceRejected, // maxSources other sources are active
+		Duplicate,      // Same sequence as the previous packet
+		Reordered,      // Older than a packet already seen
+		Standby         // A higher-priority source is live
+	};
+
+	// Output priority level changed with this packet
+	enum class Switch
+	{
+		None,
+		Failover, // Down to a lower priority, the higher ones went silent
+		Recovery  // Back up to a higher priority
+	};
+
+	struct Result
+	{
+		Status status;
+		const uint8_t *data; // Set for Status::Output
+		uint16_t length;
+		uint8_t lost; // Sequence numbers skipped before this packet
+		Switch sourceSwitch;
+	};
+
+	struct Settings
+	{
+		Mode mode;
+		size_t maxSources;
+		// Silence after which a source no longer holds off lower priorities
+		Clock::duration failoverTimeout;
+	};
+
+	static constexpr size_t MAX_SOURCES = 4;
+	static constexpr std::chrono::seconds SOURCE_TIMEOUT
+	{ 10 };
+	// A source silent this long may restart its sequence anywhere
+	static constexpr std::chrono::seconds SEQUENCE_RESYNC
+	{ 1 };
+	// This many "older" packets in a row are taken as a sender restart
+	static constexpr uint8_t MAX_REORDERED_IN_A_ROW = 4;
+
+	// Feeds one packet. A single live source passes through untouched.
+	// Sequence 0 disables the ordering checks for that packet, as the spec
+	// says. Higher `priority` wins.
+	Result merge(uint32_t ip, uint8_t physical, uint8_t priority,
+			uint8_t sequence, const uint8_t *data, uint16_t length,
+			const Settings &settings, Clock::time_point now);
+
+	// Sources heard from within SOURCE_TIMEOUT, as of the last merge()
+	size_t activeSources() const
+	{
+		return m_activeSources;
+	}
+
+	// Sources making up the output, as of the last merge()
+	size_t mergingSources() const
+	{
+		return m_mergingSources;
+	}
+
+private:
+	struct Source
+	{
+		uint32_t ip = 0;
+		uint8_t physical = 0;
+		uint8_t priority = 0;
+		bool active = false;
+		uint8_t sequence = 0; // Last accepted, 0 while unknown
+		uint8_t reorderedInARow = 0;
+		uint16_t length = 0;
+		Clock::time_point lastSeen;
+		std::array<uint8_t, ARTNET_MAX_DMX_SIZE> data
+		{ };
+	};
+
+	Source* acquireSource(uint32_t ip, uint8_t physical, size_t maxSources,
+			bool &isNew);
+	static Status checkSequence(Source &source, uint8_t sequence,
+			Clock::time_point now, uint8_t &lost);
+	// Live at the output priority level
+	static bool isMerged(const Source &source, uint8_t priority,
+			const Settings &settings, Clock::time_point now);
+
+	std::array<Source, MAX_SOURCES> m_sources;
+	size_t m_activeSources = 0;
+	size_t m_mergingSources = 0;
+	int m_outputPriority = -1; // Level the output came from, -1 before any
+	std::array<uint8_t, ARTNET_MAX_DMX_SIZE> m_output
+	{ };
+	uint16_t m_outputLength = 0;
+};
+
+} // namespace ArtNet
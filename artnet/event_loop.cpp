@@ -0,0 +1,363 @@
+#include "event_loop.h"
+#include "logging.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#else
+#include <algorithm>
+#include <poll.h>
+#endif
+
+namespace ArtNet
+{
+
+namespace
+{
+
+constexpr int MAX_EVENTS = 16;
+
+#ifdef __linux__
+timespec toTimespec(std::chrono::nanoseconds duration)
+{
+	timespec ts;
+	ts.tv_sec = static_cast<time_t>(duration.count() / 1000000000);
+	ts.tv_nsec = static_cast<long>(duration.count() % 1000000000);
+	return ts;
+}
+#endif
+
+} // namespace
+
+EventLoop::~EventLoop()
+{
+	close();
+}
+
+bool EventLoop::open()
+{
+	close();
+	m_stopRequested = false;
+
+#ifdef __linux__
+	m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (m_epollFd == -1)
+	{
+		Logger::error("epoll_create1 failed: ", strerror(errno));
+		return false;
+	}
+
+	m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (m_wakeFd == -1)
+	{
+		Logger::error("eventfd failed: ", strerror(errno));
+		close();
+		return false;
+	}
+#else
+	int fds[2];
+	if (pipe(fds) == -1)
+	{
+		Logger::error("pipe failed: ", strerror(errno));
+		return false;
+	}
+	for (int fd : fds)
+	{
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+	}
+	m_wakeFd = fds[0];
+	m_wakeWriteFd = fds[1];
+#endif
+
+	return addSource(SourceType::Wakeup, m_wakeFd, nullptr);
+}
+
+void EventLoop::close()
+{
+	for (Source &source : m_sources)
+	{
+		// Sockets belong to the caller, timers and the wakeup fd to us
+		if (source.type == SourceType::Timer && source.fd != -1)
+			::close(source.fd);
+	}
+	m_sources.clear();
+
+	if (m_wakeFd != -1)
+	{
+		::close(m_wakeFd);
+		m_wakeFd = -1;
+	}
+	if (m_wakeWriteFd != -1)
+	{
+		::close(m_wakeWriteFd);
+		m_wakeWriteFd = -1;
+	}
+	if (m_epollFd != -1)
+	{
+		::close(m_epollFd);
+		m_epollFd = -1;
+	}
+}
+
+bool EventLoop::addSource(SourceType type, int fd, Handler handler)
+{
+#ifdef __linux__
+	if (fd != -1)
+	{
+		epoll_event event
+		{ };
+		event.events = EPOLLIN;
+		event.data.u32 = static_cast<uint32_t>(m_sources.size());
+		if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) == -1)
+		{
+			Logger::error("epoll_ctl failed: ", strerror(errno));
+			return false;
+		}
+	}
+#endif
+
+	m_sources.push_back(Source
+	{ type, fd, std::move(handler), { }, std::chrono::nanoseconds(0) });
+	return true;
+}
+
+bool EventLoop::addReadable(int fd, Handler handler)
+{
+	return addSource(SourceType::Readable, fd, std::move(handler));
+}
+
+int EventLoop::addTimer(Handler handler)
+{
+	int fd = -1;
+#ifdef __linux__
+	fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (fd == -1)
+	{
+		Logger::error("timerfd_create failed: ", strerror(errno));
+		return -1;
+	}
+#endif
+
+	int timer = static_cast<int>(m_sources.size());
+	if (!addSource(SourceType::Timer, fd, std::move(handler)))
+	{
+		if (fd != -1)
+			::close(fd);
+		return -1;
+	}
+	return timer;
+}
+
+bool EventLoop::armTimer(int timer, std::chrono::nanoseconds interval)
+{
+	if (timer < 0 || static_cast<size_t>(timer) >= m_sources.size()
+			|| m_sources[timer].type != SourceType::Timer)
+		return false;
+
+	Source &source = m_sources[timer];
+
+#ifdef __linux__
+	itimerspec spec
+	{ };
+	spec.it_interval = toTimespec(interval);
+	spec.it_value = spec.it_interval; // All zero disarms
+	if (timerfd_settime(source.fd, 0, &spec, nullptr) == -1)
+	{
+		Logger::error("timerfd_settime failed: ", strerror(errno));
+		return false;
+	}
+#else
+	{
+		std::lock_guard<std::mutex> lock(m_timerMutex);
+		source.interval = interval;
+		source.deadline = std::chrono::steady_clock::now() + interval;
+	}
+	wake(); // Recompute the poll timeout
+#endif
+	return true;
+}
+
+void EventLoop::setWakeHandler(Handler handler)
+{
+	for (Source &source : m_sources)
+	{
+		if (source.type == SourceType::Wakeup)
+			source.handler = std::move(handler);
+	}
+}
+
+void EventLoop::stop()
+{
+	m_stopRequested = true;
+	wake();
+}
+
+void EventLoop::wake()
+{
+	if (m_wakeFd == -1)
+		return;
+
+#ifdef __linux__
+	uint64_t one = 1;
+	ssize_t written = write(m_wakeFd, &one, sizeof(one));
+#else
+	uint8_t one = 1;
+	ssize_t written = write(m_wakeWriteFd, &one, sizeof(one));
+#endif
+	(void) written; // A full counter or pipe already means "wake up"
+}
+
+void EventLoop::drainWakeup()
+{
+#ifdef __linux__
+	uint64_t count;
+	ssize_t drained = read(m_wakeFd, &count, sizeof(count));
+#else
+	uint8_t buffer[64];
+	ssize_t drained;
+	while ((drained = read(m_wakeFd, buffer, sizeof(buffer))) > 0)
+	{
+	}
+#endif
+	(void) drained;
+}
+
+#ifdef __linux__
+
+void EventLoop::run()
+{
+	epoll_event events[MAX_EVENTS];
+
+	while (!m_stopRequested)
+	{
+		int ready = epoll_wait(m_epollFd, events, MAX_EVENTS, -1);
+		if (ready < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			Logger::error("epoll_wait failed: ", strerror(errno));
+			return;
+		}
+
+		for (int i = 0; i < ready && !m_stopRequested; i++)
+		{
+			Source &source = m_sources[events[i].data.u32];
+			switch (source.type)
+			{
+			case SourceType::Wakeup:
+				drainWakeup();
+				if (source.handler)
+					source.handler();
+				break;
+
+			case SourceType::Timer:
+			{
+				// Missed expirations collapse into one call
+				uint64_t expirations;
+				if (read(source.fd, &expirations, sizeof(expirations))
+						== sizeof(expirations))
+					source.handler();
+				break;
+			}
+
+			case SourceType::Readable:
+				source.handler();
+				break;
+			}
+		}
+	}
+}
+
+#else
+
+int EventLoop::pollTimeout()
+{
+	std::lock_guard<std::mutex> lock(m_timerMutex);
+	auto now = std::chrono::steady_clock::now();
+	int timeout = -1;
+	for (const Source &source : m_sources)
+	{
+		if (source.type != SourceType::Timer || source.interval.count() == 0)
+			continue;
+
+		auto wait = std::chrono::ceil<std::chrono::milliseconds>(
+				source.deadline - now).count();
+		int ms = static_cast<int>(std::max<decltype(wait)>(wait, 0));
+		timeout = timeout < 0 ? ms : std::min(timeout, ms);
+	}
+	return timeout;
+}
+
+void EventLoop::runDueTimers()
+{
+	auto now = std::chrono::steady_clock::now();
+	for (Source &source : m_sources)
+	{
+		if (source.type != SourceType::Timer)
+			continue;
+
+		{
+			std::lock_guard<std::mutex> lock(m_timerMutex);
+			if (source.interval.count() == 0 || source.deadline > now)
+				continue;
+			// Missed expirations collapse into one call
+			while (source.deadline <= now)
+				source.deadline += source.interval;
+		}
+		source.handler();
+	}
+}
+
+void EventLoop::run()
+{
+	std::vector<pollfd> fds;
+	std::vector<size_t> fdSources;
+	for (size_t i = 0; i < m_sources.size(); i++)
+	{
+		if (m_sources[i].fd == -1)
+			continue;
+		fds.push_back(pollfd
+		{ m_sources[i].fd, POLLIN, 0 });
+		fdSources.push_back(i);
+	}
+
+	while (!m_stopRequested)
+	{
+		int ready = poll(fds.data(), static_cast<nfds_t>(fds.size()),
+				pollTimeout());
+		if (ready < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			Logger::error("poll failed: ", strerror(errno));
+			return;
+		}
+
+		for (size_t i = 0; i < fds.size() && !m_stopRequested; i++)
+		{
+			if (!(fds[i].revents & POLLIN))
+				continue;
+
+			Source &source = m_sources[fdSources[i]];
+			if (source.type == SourceType::Wakeup)
+				drainWakeup();
+			if (source.handler)
+				source.handler();
+		}
+
+		if (!m_stopRequested)
+			runDueTimers();
+	}
+}
+
+#endif
+
+} // namespace ArtNet
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace ArtNet
+{
+
+// Single-threaded reactor: waits on sockets and periodic timers and calls
+// their handlers from run(). Uses epoll, eventfd and timerfd on Linux and
+// poll() with a self-pipe elsewhere. Nothing wakes it while idle.
+class EventLoop
+{
+public:
+	using Handler = std::function<void()>;
+
+	EventLoop() = default;
+	~EventLoop();
+
+	EventLoop(const EventLoop&) = delete;
+	EventLoop& operator=(const EventLoop&) = delete;
+
+	bool open();
+	void close();
+
+	// Register before run(). Handlers run on the thread calling run().
+	bool addReadable(int fd, Handler handler);
+	// Returns a timer id, the timer starts disarmed
+	int addTimer(Handler handler);
+
+	// Fires every `interval` from now on, 0 disarms. Any thread.
+	bool armTimer(int timer, std::chrono::nanoseconds interval);
+
+	// Runs on the loop's thread after wake(), set after open() and before
+	// run()
+	void setWakeHandler(Handler handler);
+	// Calls the wake handler soon, wakes pending together run it once. Any
+	// thread.
+	void wake();
+
+	// Dispatches until stop()
+	void run();
+	// Makes run() return right away. Any thread.
+	void stop();
+
+private:
+	enum class SourceType
+	{
+		Readable, Timer, Wakeup
+	};
+
+	struct Source
+	{
+		SourceType type;
+		int fd;
+		Handler handler;
+		// Timer state for the poll() backend, guarded by m_timerMutex
+		std::chrono::steady_clock::time_point deadline;
+		std::chrono::nanoseconds interval
+		{ 0 };
+	};
+
+	bool addSource(SourceType type, int fd, Handler handler);
+	void drainWakeup();
+#ifndef __linux__
+	int pollTimeout();
+	void runDueTimers();
+#endif
+
+	std::vector<Source> m_sources;
+	std::atomic<bool> m_stopRequested
+	{ false };
+	int m_epollFd = -1;
+	int m_wakeFd = -1;      // eventfd, or the read end of the pipe
+	int m_wakeWriteFd = -1; // Write end of the pipe, -1 on Linux
+	std::mutex m_timerMutex;
+};
+
+} // namespace ArtNet
@@ -183,24 +183,29 @@ int main(int argc, char *argv[])
 	std::mt19937 gen(rd());
 	std::uniform_int_distribution<> dis(0, 255);
 
-	auto frameGenerator = [&]() -> std::vector<uint8_t> 
+	// Fills the controller's own buffers, nothing is allocated per frame
+	auto frameRenderer = [&](ArtNet::ArtNetController::UniverseFrame *frames,
+			size_t count, std::vector<bool> &dirty) 
 	{
-		std::vector<uint8_t> dmxData(512);
-
-		for (size_t i = 0; i < dmxData.size(); i++)
+		for (size_t u = 0; u < count; u++)
 		{
-			dmxData[i] = static_cast<uint8_t>(dis(gen));
+			frames[u].length = ArtNet::ARTNET_MAX_DMX_SIZE;
+			for (size_t i = 0; i < frames[u].length; i++)
+			{
+				frames[u].data[i] = static_cast<uint8_t>(dis(gen));
+			}
+			dirty[u] = true;
 		}
-
-		return dmxData;
 	};
+	const std::vector<uint16_t> universes
+	{ ArtNet::makePortAddress(config.net, config.subnet, config.universe) };
 
 	// Set ArtNet callback
 	// TODO: Rename to callbackDataDmx
 	// controller.registerDataCallback(myDataCallback);
 
 	// Start ArtNet controller
-	if (!controller.start(frameGenerator, ArtNet::ARTNET_FPS))
+	if (!controller.start(frameRenderer, universes, ArtNet::ARTNET_FPS))
 	{
 		ArtNet::Logger::error("Start error");
 		return 1;
@@ -219,6 +224,9 @@ int main(int argc, char *argv[])
 			std::cout << "\rFrames: " << stats.totalFrames << " | Queue: "
 					<< stats.queueDepth << " | Dropped: " << stats.droppedFrames
 					<< " | Frame time: " << stats.lastFrameTime.count() << "µs"
+					<< " | Packets: " << stats.packetsSent << " | Syscalls: "
+					<< stats.sendSyscalls << " | Wakeup p99: "
+					<< stats.scheduler.wakeupLateness.p99.count() / 1000 << "µs"
 					<< std::endl << std::flush;
 		}
 		std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -0,0 +1,204 @@
+#include "frame_scheduler.h"
+#include "logging.h"
+
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/timerfd.h>
+#endif
+
+namespace ArtNet
+{
+
+namespace
+{
+
+// steady_clock is CLOCK_MONOTONIC on Linux, so its epoch can be handed to
+// the kernel as an absolute time
+timespec toTimespec(FrameScheduler::Clock::time_point point)
+{
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			point.time_since_epoch()).count();
+	timespec ts;
+	ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+	ts.tv_nsec = static_cast<long>(ns % 1000000000);
+	return ts;
+}
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+FrameScheduler::~FrameScheduler()
+{
+	stop();
+}
+
+void FrameScheduler::setStrategy(Strategy strategy)
+{
+	m_strategy = strategy;
+}
+
+void FrameScheduler::setOverrunPolicy(OverrunPolicy policy)
+{
+	m_overrunPolicy = policy;
+}
+
+void FrameScheduler::setSpinThreshold(std::chrono::microseconds threshold)
+{
+	m_spinThreshold = threshold;
+}
+
+bool FrameScheduler::start(std::chrono::nanoseconds interval)
+{
+	stop();
+
+	m_interval = interval;
+	m_activeStrategy = m_strategy;
+
+#ifdef __linux__
+	if (m_activeStrategy == Strategy::TimerFd)
+	{
+		m_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+		if (m_timerFd == -1)
+		{
+			Logger::error("timerfd_create failed: ", strerror(errno),
+					", falling back to clock_nanosleep");
+			m_activeStrategy = Strategy::ClockNanosleep;
+		}
+	}
+#else
+	if (m_activeStrategy == Strategy::ClockNanosleep
+			|| m_activeStrategy == Strategy::TimerFd)
+	{
+		Logger::info("Scheduler strategy not available, using sleep_until");
+		m_activeStrategy = Strategy::SleepUntil;
+	}
+#endif
+
+	m_lateness.reset();
+	m_overruns = 0;
+	m_skippedFrames = 0;
+	m_nextFrame = Clock::now();
+	return true;
+}
+
+void FrameScheduler::stop()
+{
+	if (m_timerFd != -1)
+	{
+		close(m_timerFd);
+		m_timerFd = -1;
+	}
+}
+
+std::chrono::nanoseconds FrameScheduler::waitNextFrame()
+{
+	m_nextFrame += m_interval;
+
+	Clock::time_point now = Clock::now();
+	if (now > m_nextFrame)
+	{
+		m_overruns++;
+		if (m_overrunPolicy == OverrunPolicy::SkipAhead)
+		{
+			// Next grid slot still in the future, instead of a burst
+			auto missed = (now - m_nextFrame) / m_interval + 1;
+			m_nextFrame += missed * m_interval;
+			m_skippedFrames += static_cast<uint64_t>(missed);
+		}
+	}
+
+	sleepUntil(m_nextFrame);
+
+	std::chrono::nanoseconds lateness = Clock::now() - m_nextFrame;
+	m_lateness.record(lateness);
+	return lateness;
+}
+
+void FrameScheduler::sleepUntil(Clock::time_point deadline)
+{
+	switch (m_activeStrategy)
+	{
+#ifdef __linux__
+	case Strategy::ClockNanosleep:
+	{
+		timespec ts = toTimespec(deadline);
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr)
+				== EINTR)
+		{
+		}
+		break;
+	}
+
+	case Strategy::TimerFd:
+	{
+		itimerspec spec
+		{ };
+		spec.it_value = toTimespec(deadline);
+		if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+			spec.it_value.tv_nsec = 1; // All zero would disarm the timer
+		if (timerfd_settime(m_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) == 0)
+		{
+			uint64_t expirations;
+			while (read(m_timerFd, &expirations, sizeof(expirations)) == -1
+					&& errno == EINTR)
+			{
+			}
+		}
+		break;
+	}
+#endif
+
+	case Strategy::HybridSpin:
+	{
+		Clock::time_point wakeup = deadline - m_spinThreshold;
+		if (Clock::now() < wakeup)
+		{
+#ifdef __linux__
+			timespec ts = toTimespec(wakeup);
+			while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts,
+					nullptr) == EINTR)
+			{
+			}
+#else
+			std::this_thread::sleep_until(wakeup);
+#endif
+		}
+		spinUntil(deadline);
+		break;
+	}
+
+	case Strategy::SleepUntil:
+	default:
+		std::this_thread::sleep_until(deadline);
+		break;
+	}
+}
+
+void FrameScheduler::spinUntil(Clock::time_point deadline)
+{
+	while (Clock::now() < deadline)
+	{
+		cpuRelax();
+	}
+}
+
+FrameScheduler::Statistics FrameScheduler::getStatistics() const
+{
+	return Statistics
+	{ m_lateness.getSnapshot(), m_overruns.load(), m_skippedFrames.load() };
+}
+
+} // namespace ArtNet
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "latency_histogram.h"
+
+namespace ArtNet
+{
+
+// Paces the frame processor on an absolute time grid and measures how late
+// every wakeup is.
+class FrameScheduler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// How to wait for the next frame
+	enum class Strategy
+	{
+		SleepUntil,     // std::this_thread::sleep_until
+		ClockNanosleep, // clock_nanosleep(TIMER_ABSTIME), Linux only
+		TimerFd,        // Blocking read on an absolute timerfd, Linux only
+		HybridSpin      // Sleep, then spin for the last SPIN_THRESHOLD
+	};
+
+	// What to do when a frame finishes after the next one was due
+	enum class OverrunPolicy
+	{
+		SkipAhead, // Drop the missed slots and realign to the grid
+		CatchUp    // Run the missed frames back to back
+	};
+
+	static constexpr std::chrono::microseconds DEFAULT_SPIN_THRESHOLD
+	{ 200 };
+
+	struct Statistics
+	{
+		LatencyHistogram::Snapshot wakeupLateness;
+		uint64_t overruns;      // Frames that finished past the next deadline
+		uint64_t skippedFrames; // Slots dropped by SkipAhead
+	};
+
+	FrameScheduler() = default;
+	~FrameScheduler();
+
+	FrameScheduler(const FrameScheduler&) = delete;
+	FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+	// Takes effect on the next start()
+	void setStrategy(Strategy strategy);
+	void setOverrunPolicy(OverrunPolicy policy);
+	void setSpinThreshold(std::chrono::microseconds threshold);
+
+	// Anchors the grid at now and resets the statistics
+	bool start(std::chrono::nanoseconds interval);
+	void stop();
+
+	// Blocks until the next frame is due, returns the wakeup lateness
+	std::chrono::nanoseconds waitNextFrame();
+
+	Statistics getStatistics() const;
+
+private:
+	void sleepUntil(Clock::time_point deadline);
+	void spinUntil(Clock::time_point deadline);
+
+	Strategy m_strategy = Strategy::SleepUntil;
+	OverrunPolicy m_overrunPolicy = OverrunPolicy::SkipAhead;
+	std::chrono::nanoseconds m_spinThreshold = DEFAULT_SPIN_THRESHOLD;
+
+	// State of the running schedule, owned by the waiting thread
+	Strategy m_activeStrategy = Strategy::SleepUntil;
+	std::chrono::nanoseconds m_interval
+	{ 0 };
+	Clock::time_point m_nextFrame;
+	int m_timerFd = -1;
+
+	LatencyHistogram m_lateness;
+	std::atomic<uint64_t> m_overruns
+	{ 0 };
+	std::atomic<uint64_t> m_skippedFrames
+	{ 0 };
+};
+
+} // namespace ArtNet
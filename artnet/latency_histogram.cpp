@@ -0,0 +1,103 @@
+#include "latency_histogram.h"
+
+#include <limits>
+
+namespace ArtNet
+{
+
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+	// Values below SUB_BUCKETS map one to one, above that the top
+	// SUB_BUCKET_BITS + 1 significant bits select the bucket
+	if (value < SUB_BUCKETS)
+		return static_cast<size_t>(value);
+
+	unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+	unsigned shift = msb - SUB_BUCKET_BITS;
+	size_t group = shift + 1;
+	size_t sub = static_cast<size_t>((value >> shift) & (SUB_BUCKETS - 1));
+	return group * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+	if (index < SUB_BUCKETS)
+		return index;
+
+	size_t group = index / SUB_BUCKETS;
+	uint64_t sub = index % SUB_BUCKETS;
+	unsigned shift = static_cast<unsigned>(group - 1);
+	uint64_t lower = (SUB_BUCKETS + sub) << shift;
+	return lower + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds value)
+{
+	uint64_t ns = value.count() > 0 ? static_cast<uint64_t>(value.count()) : 0;
+
+	m_buckets[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+	m_sum.fetch_add(ns, std::memory_order_relaxed);
+
+	// Single writer, plain load/store is enough for min and max
+	if (ns < m_min.load(std::memory_order_relaxed))
+		m_min.store(ns, std::memory_order_relaxed);
+	if (ns > m_max.load(std::memory_order_relaxed))
+		m_max.store(ns, std::memory_order_relaxed);
+
+	m_count.fetch_add(1, std::memory_order_release);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::getSnapshot() const
+{
+	uint64_t count = m_count.load(std::memory_order_acquire);
+	if (count == 0)
+	{
+		return Snapshot
+		{ 0, std::chrono::nanoseconds(0), std::chrono::nanoseconds(0),
+				std::chrono::nanoseconds(0), std::chrono::nanoseconds(0) };
+	}
+
+	uint64_t max = m_max.load(std::memory_order_relaxed);
+
+	// Upper bound of the bucket holding the 99th percentile sample
+	uint64_t rank = (count * 99 + 99) / 100;
+	uint64_t seen = 0;
+	uint64_t p99 = max;
+	for (size_t i = 0; i < BUCKET_COUNT; i++)
+	{
+		seen += m_buckets[i].load(std::memory_order_relaxed);
+		if (seen >= rank)
+		{
+			p99 = bucketUpperBound(i);
+			break;
+		}
+	}
+	if (p99 > max)
+		p99 = max;
+
+	return Snapshot
+	{ count, std::chrono::nanoseconds(m_min.load(std::memory_order_relaxed)),
+			std::chrono::nanoseconds(
+					m_sum.load(std::memory_order_relaxed) / count),
+			std::chrono::nanoseconds(p99), std::chrono::nanoseconds(max) };
+}
+
+void LatencyHistogram::reset()
+{
+	for (std::atomic<uint64_t> &bucket : m_buckets)
+	{
+		bucket.store(0, std::memory_order_relaxed);
+	}
+	m_count.store(0, std::memory_order_relaxed);
+	m_sum.store(0, std::memory_order_relaxed);
+	m_min.store(std::numeric_limits<uint64_t>::max(),
+			std::memory_order_relaxed);
+	m_max.store(0, std::memory_order_relaxed);
+}
+
+} // namespace ArtNet
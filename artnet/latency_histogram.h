@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ArtNet
+{
+
+// Log-linear histogram of durations: every power of two of nanoseconds is
+// split into SUB_BUCKETS linear buckets, so percentiles are accurate to
+// about 6% at any scale. One thread records, any thread may take snapshots.
+class LatencyHistogram
+{
+public:
+	struct Snapshot
+	{
+		uint64_t count;
+		std::chrono::nanoseconds min;
+		std::chrono::nanoseconds avg;
+		std::chrono::nanoseconds p99;
+		std::chrono::nanoseconds max;
+	};
+
+	LatencyHistogram();
+
+	void record(std::chrono::nanoseconds value);
+	Snapshot getSnapshot() const;
+	void reset();
+
+private:
+	static constexpr unsigned SUB_BUCKET_BITS = 4;
+	static constexpr unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+	static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1)
+			* SUB_BUCKETS;
+
+	static size_t bucketIndex(uint64_t value);
+	static uint64_t bucketUpperBound(size_t index);
+
+	std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets;
+	std::atomic<uint64_t> m_count
+	{ 0 };
+	std::atomic<uint64_t> m_sum
+	{ 0 };
+	std::atomic<uint64_t> m_min;
+	std::atomic<uint64_t> m_max
+	{ 0 };
+};
+
+} // namespace ArtNet
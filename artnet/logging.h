@@ -25,7 +25,7 @@ public:
 		return s_level;
 	}
 
-	template<typename ... Args> static void error(Args ... args)
+	template<typename ... Args> static void error(const Args &... args)
 	{
 		if (s_level >= LogLevel::ERROR)
 		{
@@ -34,7 +34,7 @@ public:
 		}
 	}
 
-	template<typename ... Args> static void info(Args ... args)
+	template<typename ... Args> static void info(const Args &... args)
 	{
 		if (s_level >= LogLevel::INFO)
 		{
@@ -43,7 +43,7 @@ public:
 		}
 	}
 
-	template<typename ... Args> static void debug(Args ... args)
+	template<typename ... Args> static void debug(const Args &... args)
 	{
 		if (s_level >= LogLevel::DEBUG)
 		{
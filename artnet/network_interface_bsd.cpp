@@ -10,11 +10,6 @@
 
 namespace ArtNet
 {
-NetworkInterfaceBSD::NetworkInterfaceBSD() :
-		m_recvBuffer(MAX_PACKET_SIZE)
-{
-}
-
 int NetworkInterfaceBSD::getSocket() const
 {
 	return m_socket;
@@ -132,8 +127,8 @@ bool NetworkInterfaceBSD::bindSocket()
 	return true;
 }
 
-bool NetworkInterfaceBSD::sendPacket(const std::vector<uint8_t> &packet,
-		const std::string &address, int port)
+bool NetworkInterfaceBSD::sendPacket(const iovec *segments, size_t count,
+		const Endpoint &destination)
 {
 	if (m_socket == -1)
 	{
@@ -141,18 +136,15 @@ bool NetworkInterfaceBSD::sendPacket(const std::vector<uint8_t> &packet,
 		return false;
 	}
 
-	sockaddr_in broadcastAddr;
-	broadcastAddr.sin_family = AF_INET;
-	broadcastAddr.sin_port = htons(port);
-	broadcastAddr.sin_addr.s_addr = inet_addr(address.c_str());
-
-	Logger::debug("Sending packet:", "\n  Destination: ",
-			inet_ntoa(broadcastAddr.sin_addr), "\n  Port: ",
-			ntohs(broadcastAddr.sin_port), "\n  Packet size: ", packet.size(),
-			" bytes");
+	msghdr header
+	{ };
+	header.msg_name = const_cast<sockaddr_in*>(&destination.address);
+	header.msg_namelen = sizeof(destination.address);
+	header.msg_iov = const_cast<iovec*>(segments);
+	header.msg_iovlen = static_cast<int>(count);
 
-	ssize_t bytesSent = sendto(m_socket, packet.data(), packet.size(), 0,
-			reinterpret_cast<sockaddr*>(&broadcastAddr), sizeof(broadcastAddr));
+	ssize_t bytesSent = sendmsg(m_socket, &header, 0);
+	m_sendCalls++;
 
 	if (bytesSent == -1)
 	{
@@ -161,34 +153,59 @@ bool NetworkInterfaceBSD::sendPacket(const std::vector<uint8_t> &packet,
 		return false;
 	}
 
+	if (Logger::getLevel() >= LogLevel::DEBUG)
+	{
+		Logger::debug("Sending packet:", "\n  Destination: ",
+				inet_ntoa(destination.address.sin_addr), "\n  Port: ",
+				destination.port(), "\n  Packet size: ", bytesSent, " bytes");
+	}
+
+	m_packetsSent++;
 	return true;
 }
 
-int NetworkInterfaceBSD::receivePacket(std::vector<uint8_t> &buffer)
+size_t NetworkInterfaceBSD::sendPackets(const OutgoingPacket *packets,
+		size_t count)
+{
+	// No sendmmsg() on BSD/macOS, one sendmsg() per packet
+	size_t sent = 0;
+	for (; sent < count; sent++)
+	{
+		const OutgoingPacket &packet = packets[sent];
+		if (!sendPacket(packet.segments.data(), packet.segmentCount,
+				packet.destination))
+			break;
+	}
+
+	return sent;
+}
+
+int NetworkInterfaceBSD::receivePacket(uint8_t *buffer, size_t capacity,
+		Endpoint &sender)
 {
-	sockaddr_in senderAddr;
-	socklen_t addrLen = sizeof(senderAddr);
+	socklen_t addrLen = sizeof(sender.address);
 
-	ssize_t bytesReceived = recvfrom(m_socket, m_recvBuffer.data(),
-			m_recvBuffer.size(), 0, reinterpret_cast<sockaddr*>(&senderAddr),
-			&addrLen);
+	ssize_t bytesReceived = recvfrom(m_socket, buffer, capacity,
+			m_nonBlockingReceive ? MSG_DONTWAIT : 0,
+			reinterpret_cast<sockaddr*>(&sender.address), &addrLen);
 	if (bytesReceived == -1)
 	{
-		if (errno != EAGAIN && errno != EWOULDBLOCK)
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
 		{
-			Logger::error("Error receiving data: ", strerror(errno));
+			return 0; // Timed out, no data
 		}
-		return 0; // Non-blocking socket returns 0 if no data
+		return -1;
 	}
 
-	buffer.assign(m_recvBuffer.begin(), m_recvBuffer.begin() + bytesReceived);
-
-	char senderIP[INET_ADDRSTRLEN];
-	inet_ntop(AF_INET, &(senderAddr.sin_addr), senderIP, INET_ADDRSTRLEN);
+	if (Logger::getLevel() >= LogLevel::DEBUG)
+	{
+		char senderIP[INET_ADDRSTRLEN];
+		inet_ntop(AF_INET, &(sender.address.sin_addr), senderIP,
+				INET_ADDRSTRLEN);
 
-	Logger::debug("Packet received:", "\n  From: ", senderIP, "\n  Port: ",
-			ntohs(senderAddr.sin_port), "\n  Bytes received: ", bytesReceived,
-			"\n  Buffer size: ", buffer.size());
+		Logger::debug("Packet received:", "\n  From: ", senderIP, "\n  Port: ",
+				sender.port(), "\n  Bytes received: ", bytesReceived);
+	}
 
 	return static_cast<int>(bytesReceived);
 }
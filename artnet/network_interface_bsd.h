@@ -9,21 +9,23 @@ namespace ArtNet
 class NetworkInterfaceBSD: public NetworkInterface
 {
 public:
-	NetworkInterfaceBSD();
+	NetworkInterfaceBSD() = default;
 	~NetworkInterfaceBSD() override = default;
 
 	bool createSocket(const std::string &bindAddress, int port) override;
 	bool bindSocket() override;
-	bool sendPacket(const std::vector<uint8_t> &packet,
-			const std::string &address, int port) override;
-	int receivePacket(std::vector<uint8_t> &buffer) override;
+	using NetworkInterface::sendPacket;
+	bool sendPacket(const iovec *segments, size_t count,
+			const Endpoint &destination) override;
+	size_t sendPackets(const OutgoingPacket *packets, size_t count) override;
+	int receivePacket(uint8_t *buffer, size_t capacity, Endpoint &sender)
+			override;
 	void closeSocket() override;
 	virtual int getSocket() const override;
 
 private:
 	int m_socket = -1;
 	std::string m_bindAddress;
-	int m_port;
-	std::vector<uint8_t> m_recvBuffer;
+	int m_port = 0;
 };
 } // namespace ArtNet
@@ -0,0 +1,548 @@
+#include "network_interface_io_uring.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <linux/errqueue.h>
+#include <linux/time_types.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ArtNet
+{
+
+// Room for the largest timestamp control message of one datagram
+static constexpr size_t RECEIVE_CONTROL_SIZE = CMSG_SPACE(
+		sizeof(scm_timestamping));
+static constexpr uint16_t BUFFER_GROUP = 0;
+static constexpr unsigned RECEIVE_RING_ENTRIES = 4; // Only (re)arms
+// Same wait as SO_RCVTIMEO on the socket path
+static constexpr long RECEIVE_TIMEOUT_NS = 500000000;
+
+bool NetworkInterfaceIoUring::Ring::setup(unsigned entries,
+		io_uring_params &params)
+{
+	fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+	if (fd < 0)
+		return false;
+
+	sqEntries = params.sq_entries;
+	m_ringSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	m_completionRingSize = params.cq_off.cqes
+			+ params.cq_entries * sizeof(io_uring_cqe);
+	bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+	if (single)
+	{
+		m_ringSize = m_completionRingSize = std::max(m_ringSize,
+				m_completionRingSize);
+	}
+
+	m_ring = mmap(nullptr, m_ringSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (m_ring == MAP_FAILED)
+	{
+		m_ring = nullptr;
+		return false;
+	}
+	m_completionRing =
+			single ? m_ring :
+					mmap(nullptr, m_completionRingSize, PROT_READ | PROT_WRITE,
+							MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+	if (m_completionRing == MAP_FAILED)
+	{
+		m_completionRing = nullptr;
+		return false;
+	}
+	m_entriesSize = params.sq_entries * sizeof(io_uring_sqe);
+	void *entriesMap = mmap(nullptr, m_entriesSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (entriesMap == MAP_FAILED)
+		return false;
+	m_entries = static_cast<io_uring_sqe*>(entriesMap);
+
+	uint8_t *ring = static_cast<uint8_t*>(m_ring);
+	uint8_t *completionRing = static_cast<uint8_t*>(m_completionRing);
+	m_sqTail = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+	m_sqMask = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+	m_cqHead = reinterpret_cast<unsigned*>(completionRing
+			+ params.cq_off.head);
+	m_cqTail = reinterpret_cast<unsigned*>(completionRing
+			+ params.cq_off.tail);
+	m_cqMask = *reinterpret_cast<unsigned*>(completionRing
+			+ params.cq_off.ring_mask);
+	m_completions = reinterpret_cast<io_uring_cqe*>(completionRing
+			+ params.cq_off.cqes);
+
+	// Entry i always sits in slot i, the index array never changes
+	unsigned *array = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+	for (unsigned i = 0; i < params.sq_entries; i++)
+	{
+		array[i] = i;
+	}
+	return true;
+}
+
+void NetworkInterfaceIoUring::Ring::close()
+{
+	if (m_entries)
+		munmap(m_entries, m_entriesSize);
+	if (m_completionRing && m_completionRing != m_ring)
+		munmap(m_completionRing, m_completionRingSize);
+	if (m_ring)
+		munmap(m_ring, m_ringSize);
+	if (fd != -1)
+		::close(fd);
+	*this = Ring();
+}
+
+io_uring_sqe& NetworkInterfaceIoUring::Ring::prepare(unsigned index)
+{
+	// Every queued entry is submitted before the next batch is prepared
+	io_uring_sqe &entry = m_entries[(*m_sqTail + index) & m_sqMask];
+	std::memset(&entry, 0, sizeof(entry));
+	return entry;
+}
+
+void NetworkInterfaceIoUring::Ring::queue(unsigned count)
+{
+	__atomic_store_n(m_sqTail, *m_sqTail + count, __ATOMIC_RELEASE);
+}
+
+int NetworkInterfaceIoUring::Ring::enter(unsigned submit, unsigned wait,
+		unsigned flags, const void *arg, size_t argSize)
+{
+	return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, wait,
+			flags, arg, argSize));
+}
+
+const io_uring_cqe* NetworkInterfaceIoUring::Ring::peek() const
+{
+	unsigned head = *m_cqHead;
+	if (head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE))
+		return nullptr;
+	return &m_completions[head & m_cqMask];
+}
+
+void NetworkInterfaceIoUring::Ring::pop()
+{
+	__atomic_store_n(m_cqHead, *m_cqHead + 1, __ATOMIC_RELEASE);
+}
+
+NetworkInterfaceIoUring::~NetworkInterfaceIoUring()
+{
+	closeRings();
+}
+
+bool NetworkInterfaceIoUring::createSocket(const std::string &bindAddress,
+		int port)
+{
+	if (!NetworkInterfaceLinux::createSocket(bindAddress, port))
+		return false;
+
+	if (!setupRings())
+	{
+		int error = errno;
+		closeRings();
+		Logger::info("io_uring unavailable (", strerror(error),
+				"), using sendmmsg/recvmmsg");
+	}
+	return true;
+}
+
+bool NetworkInterfaceIoUring::setupRings()
+{
+	// Every entry is consumed even when an earlier one fails, so a failed
+	// send never leaves stale entries behind
+	io_uring_params sendParams
+	{ };
+	sendParams.flags = IORING_SETUP_SUBMIT_ALL;
+	if (!m_sendRing.setup(SEND_RING_ENTRIES, sendParams))
+		return false;
+	m_sendHeaders.resize(m_sendRing.sqEntries);
+
+	// Completions run deferred on the receiving thread, which becomes the
+	// only submitter once prepareReceive() enables the ring
+	io_uring_params receiveParams
+	{ };
+	receiveParams.flags = IORING_SETUP_SINGLE_ISSUER
+			| IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_R_DISABLED
+			| IORING_SETUP_CQSIZE;
+	receiveParams.cq_entries = 2 * RECEIVE_BUFFERS;
+	if (!m_receiveRing.setup(RECEIVE_RING_ENTRIES, receiveParams))
+		return false;
+
+	void *bufferRing = mmap(nullptr, RECEIVE_BUFFERS * sizeof(io_uring_buf),
+			PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (bufferRing == MAP_FAILED)
+		return false;
+	m_bufferRing = static_cast<io_uring_buf*>(bufferRing);
+
+	io_uring_buf_reg registration
+	{ };
+	registration.ring_addr = reinterpret_cast<uint64_t>(m_bufferRing);
+	registration.ring_entries = RECEIVE_BUFFERS;
+	registration.bgid = BUFFER_GROUP;
+	if (syscall(__NR_io_uring_register, m_receiveRing.fd,
+			IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+		return false;
+
+	m_receiveHeader = msghdr
+	{ };
+	m_receiveHeader.msg_namelen = sizeof(sockaddr_in);
+	m_receiveHeader.msg_controllen = RECEIVE_CONTROL_SIZE;
+	m_bufferSize = sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_in)
+			+ RECEIVE_CONTROL_SIZE + MAX_PACKET_SIZE;
+	m_buffers.reset(new uint8_t[RECEIVE_BUFFERS * m_bufferSize]);
+	m_bufferTail = 0;
+	for (unsigned id = 0; id < RECEIVE_BUFFERS; id++)
+	{
+		recycleBuffer(static_cast<uint16_t>(id));
+	}
+	__atomic_store_n(&m_bufferRing[0].resv, m_bufferTail, __ATOMIC_RELEASE);
+
+	m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (m_eventFd == -1)
+		return false;
+	if (syscall(__NR_io_uring_register, m_receiveRing.fd,
+			IORING_REGISTER_EVENTFD, &m_eventFd, 1) < 0)
+		return false;
+
+	m_receiveEnabled = false;
+	m_receiveArmed = false;
+	m_receiveError = 0;
+	m_backend = NetworkBackend::IoUring;
+	Logger::info("io_uring ready, ", RECEIVE_BUFFERS, " receive buffers, ",
+			m_sendRing.sqEntries, " send entries");
+	return true;
+}
+
+void NetworkInterfaceIoUring::closeRings()
+{
+	// Closing the ring cancels the multishot receive and drops the
+	// buffer registration
+	m_receiveRing.close();
+	m_sendRing.close();
+	if (m_bufferRing)
+	{
+		munmap(m_bufferRing, RECEIVE_BUFFERS * sizeof(io_uring_buf));
+		m_bufferRing = nullptr;
+	}
+	m_buffers.reset();
+	if (m_eventFd != -1)
+	{
+		close(m_eventFd);
+		m_eventFd = -1;
+	}
+	m_receiveEnabled = false;
+	m_receiveArmed = false;
+	m_backend = NetworkBackend::Sockets;
+}
+
+void NetworkInterfaceIoUring::closeSocket()
+{
+	closeRings();
+	NetworkInterfaceLinux::closeSocket();
+}
+
+int NetworkInterfaceIoUring::getReceiveHandle() const
+{
+	return m_eventFd != -1 ? m_eventFd : getSocket();
+}
+
+NetworkBackend NetworkInterfaceIoUring::getBackend() const
+{
+	return m_backend;
+}
+
+size_t NetworkInterfaceIoUring::sendPackets(const OutgoingPacket *packets,
+		size_t count)
+{
+	std::unique_lock<std::mutex> lock(m_sendMutex);
+	if (m_sendRing.fd == -1)
+	{
+		lock.unlock();
+		return NetworkInterfaceLinux::sendPackets(packets, count);
+	}
+
+	// Numbering of timestamped datagrams must follow the send order
+	bool stamping = getTimestamping() == Timestamping::ReceiveAndSend;
+	std::unique_lock<std::mutex> txLock(m_txMutex, std::defer_lock);
+	std::chrono::nanoseconds submitted
+	{ 0 };
+	if (stamping)
+	{
+		txLock.lock();
+		submitted = std::chrono::system_clock::now().time_since_epoch();
+	}
+
+	size_t sent = 0;
+	int error = 0;
+	for (size_t offset = 0; offset < count && error == 0;)
+	{
+		unsigned chunk = static_cast<unsigned>(std::min<size_t>(
+				count - offset, m_sendRing.sqEntries));
+
+		// Segments are referenced in place, payloads are never copied
+		for (unsigned i = 0; i < chunk; i++)
+		{
+			const OutgoingPacket &packet = packets[offset + i];
+			msghdr &header = m_sendHeaders[i];
+			std::memset(&header, 0, sizeof(header));
+			header.msg_name = const_cast<sockaddr_in*>(
+					&packet.destination.address);
+			header.msg_namelen = sizeof(sockaddr_in);
+			header.msg_iov = const_cast<iovec*>(packet.segments.data());
+			header.msg_iovlen = packet.segmentCount;
+
+			io_uring_sqe &entry = m_sendRing.prepare(i);
+			entry.opcode = IORING_OP_SENDMSG;
+			entry.fd = getSocket();
+			entry.addr = reinterpret_cast<uint64_t>(&header);
+			entry.len = 1;
+			entry.user_data = i;
+		}
+		m_sendRing.queue(chunk);
+
+		// Submits the chunk and waits for all of it in the same call, so the
+		// caller's buffers are free again on return
+		unsigned unsubmitted = chunk;
+		unsigned completed = 0;
+		while (completed < chunk)
+		{
+			int result = m_sendRing.enter(unsubmitted, chunk - completed,
+					IORING_ENTER_GETEVENTS);
+			m_sendCalls++;
+			if (result < 0 && errno != EINTR && errno != EAGAIN
+					&& errno != EBUSY)
+			{
+				// Entries may still sit in the ring, so it is not reused
+				Logger::error("io_uring send failed, using sendmmsg: ",
+						strerror(errno));
+				m_sendRing.close();
+				if (stamping)
+					recordSubmitted(sent, submitted);
+				return sent;
+			}
+			if (result > 0)
+				unsubmitted -= std::min(static_cast<unsigned>(result),
+						unsubmitted);
+
+			while (const io_uring_cqe *completion = m_sendRing.peek())
+			{
+				if (completion->res >= 0)
+					sent++;
+				else if (error == 0)
+					error = -completion->res;
+				completed++;
+				m_sendRing.pop();
+			}
+		}
+		offset += chunk;
+	}
+
+	m_packetsSent += sent;
+	if (stamping)
+		recordSubmitted(sent, submitted);
+	if (error != 0)
+	{
+		Logger::error("Error sending packet batch: ", strerror(error));
+	}
+	return sent;
+}
+
+void NetworkInterfaceIoUring::prepareReceive()
+{
+	if (m_receiveRing.fd == -1 || m_receiveEnabled)
+		return;
+
+	if (syscall(__NR_io_uring_register, m_receiveRing.fd,
+			IORING_REGISTER_ENABLE_RINGS, nullptr, 0) < 0)
+	{
+		Logger::error("Failed to enable io_uring receive ring: ",
+				strerror(errno));
+		return;
+	}
+	m_receiveEnabled = true;
+	armReceive();
+}
+
+bool NetworkInterfaceIoUring::armReceive()
+{
+	// One recvmsg that keeps completing, one datagram per completion
+	io_uring_sqe &entry = m_receiveRing.prepare(0);
+	entry.opcode = IORING_OP_RECVMSG;
+	entry.fd = getSocket();
+	entry.addr = reinterpret_cast<uint64_t>(&m_receiveHeader);
+	entry.len = 1;
+	entry.ioprio = IORING_RECV_MULTISHOT;
+	entry.flags = IOSQE_BUFFER_SELECT;
+	entry.buf_group = BUFFER_GROUP;
+	m_receiveRing.queue(1);
+
+	m_receiveArmed = m_receiveRing.enter(1, 0, 0) == 1;
+	m_receiveCalls++;
+	if (!m_receiveArmed)
+	{
+		Logger::error("Failed to arm io_uring receive: ", strerror(errno));
+	}
+	return m_receiveArmed;
+}
+
+int NetworkInterfaceIoUring::receivePacket(uint8_t *buffer, size_t capacity,
+		Endpoint &sender)
+{
+	if (m_receiveRing.fd == -1)
+		return NetworkInterfaceLinux::receivePacket(buffer, capacity, sender);
+
+	IncomingPacket packet
+	{ buffer, capacity, 0, Endpoint(), std::chrono::nanoseconds(0) };
+	int result = receivePackets(&packet, 1);
+	if (result <= 0)
+		return result;
+	sender = packet.sender;
+	return static_cast<int>(packet.size);
+}
+
+int NetworkInterfaceIoUring::receivePackets(IncomingPacket *packets,
+		size_t count)
+{
+	if (m_receiveRing.fd == -1)
+		return NetworkInterfaceLinux::receivePackets(packets, count);
+	if (!m_receiveEnabled)
+	{
+		prepareReceive();
+		if (!m_receiveEnabled)
+			return -1;
+	}
+
+	if (getTimestamping() == Timestamping::ReceiveAndSend)
+	{
+		// Pending send timestamps keep the socket reporting an error
+		drainSendTimestamps();
+	}
+
+	// Cleared before reaping, so completions from here on signal again
+	eventfd_t signals;
+	eventfd_read(m_eventFd, &signals);
+
+	// Runs the completions the kernel deferred to this thread
+	m_receiveRing.enter(0, 0, IORING_ENTER_GETEVENTS);
+	m_receiveCalls++;
+	int received = reapReceived(packets, count);
+
+	if (received == 0 && !m_nonBlockingReceive && m_receiveArmed)
+	{
+		__kernel_timespec timeout
+		{ 0, RECEIVE_TIMEOUT_NS };
+		io_uring_getevents_arg arg
+		{ };
+		arg.ts = reinterpret_cast<uint64_t>(&timeout);
+		m_receiveRing.enter(0, 1,
+				IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg,
+				sizeof(arg));
+		m_receiveCalls++;
+		received = reapReceived(packets, count);
+	}
+
+	// Ends after running out of buffers or on an error, datagrams wait in
+	// the socket until it is armed again
+	if (!m_receiveArmed)
+		armReceive();
+
+	// Whatever is left keeps the handle readable
+	if (m_receiveRing.peek())
+		eventfd_write(m_eventFd, 1);
+
+	if (received == 0 && m_receiveError != 0)
+	{
+		errno = m_receiveError;
+		m_receiveError = 0;
+		return -1;
+	}
+	m_receiveError = 0;
+	if (received > 0)
+		recordReceiveBatch(static_cast<size_t>(received));
+	return received;
+}
+
+int NetworkInterfaceIoUring::reapReceived(IncomingPacket *packets,
+		size_t count)
+{
+	bool timestamps = getTimestamping() != Timestamping::Off;
+	size_t received = 0;
+	uint16_t recycled = m_bufferTail;
+
+	while (received < count)
+	{
+		const io_uring_cqe *completion = m_receiveRing.peek();
+		if (!completion)
+			break;
+		if (!(completion->flags & IORING_CQE_F_MORE))
+			m_receiveArmed = false;
+
+		bool hasBuffer = completion->flags & IORING_CQE_F_BUFFER;
+		uint16_t id = static_cast<uint16_t>(completion->flags
+				>> IORING_CQE_BUFFER_SHIFT);
+		if (completion->res < 0)
+		{
+			// Out of buffers is not an error, the datagrams stay queued
+			if (completion->res != -ENOBUFS && m_receiveError == 0)
+				m_receiveError = -completion->res;
+			if (hasBuffer)
+				recycleBuffer(id);
+			m_receiveRing.pop();
+			continue;
+		}
+
+		// Header, sender and control messages sit in front of the payload at
+		// the sizes reserved in m_receiveHeader
+		uint8_t *buffer = m_buffers.get() + id * m_bufferSize;
+		io_uring_recvmsg_out out;
+		std::memcpy(&out, buffer, sizeof(out));
+		uint8_t *name = buffer + sizeof(out);
+		uint8_t *control = name + sizeof(sockaddr_in);
+		uint8_t *payload = control + RECEIVE_CONTROL_SIZE;
+
+		IncomingPacket &packet = packets[received];
+		std::memcpy(&packet.sender.address, name,
+				std::min<size_t>(out.namelen, sizeof(sockaddr_in)));
+		packet.size = std::min<size_t>(
+				{ out.payloadlen, packet.capacity, MAX_PACKET_SIZE });
+		std::memcpy(packet.data, payload, packet.size);
+		packet.timestamp = std::chrono::nanoseconds(0);
+		if (timestamps)
+		{
+			msghdr header
+			{ };
+			header.msg_control = control;
+			header.msg_controllen = out.controllen;
+			packet.timestamp = receiveTimestamp(header);
+		}
+
+		recycleBuffer(id);
+		m_receiveRing.pop();
+		received++;
+	}
+
+	// One tail update hands every buffer of the batch back
+	if (m_bufferTail != recycled)
+		__atomic_store_n(&m_bufferRing[0].resv, m_bufferTail,
+				__ATOMIC_RELEASE);
+	return static_cast<int>(received);
+}
+
+void NetworkInterfaceIoUring::recycleBuffer(uint16_t id)
+{
+	// Only addr, len and bid are written: the ring tail shares entry 0
+	io_uring_buf &entry = m_bufferRing[m_bufferTail & (RECEIVE_BUFFERS - 1)];
+	entry.addr = reinterpret_cast<uint64_t>(m_buffers.get() + id * m_bufferSize);
+	entry.len = static_cast<uint32_t>(m_bufferSize);
+	entry.bid = id;
+	m_bufferTail++;
+}
+
+} // namespace ArtNet
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "network_interface_linux.h"
+#include <atomic>
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ArtNet
+{
+// io_uring backend (Linux 6.1+). One multishot recvmsg stays armed on the
+// socket and the kernel picks a buffer from a registered ring for every
+// datagram; receiving only reaps completions, announced on an eventfd. A
+// send batch is queued as sendmsg entries and submitted and waited for
+// with one io_uring_enter(). Socket options, pacing, sharding and kernel
+// timestamps are NetworkInterfaceLinux's, and where the rings cannot be
+// set up (old kernel, io_uring disabled) every call takes its path.
+class NetworkInterfaceIoUring: public NetworkInterfaceLinux
+{
+public:
+	// Buffers the kernel receives into, a power of two
+	static constexpr unsigned RECEIVE_BUFFERS = 256;
+	// Send entries submitted per io_uring_enter()
+	static constexpr unsigned SEND_RING_ENTRIES = 256;
+
+	NetworkInterfaceIoUring() = default;
+	~NetworkInterfaceIoUring() override;
+
+	bool createSocket(const std::string &bindAddress, int port) override;
+	size_t sendPackets(const OutgoingPacket *packets, size_t count) override;
+	int receivePacket(uint8_t *buffer, size_t capacity, Endpoint &sender)
+			override;
+	// Copies each payload out of its kernel buffer into the caller's slot,
+	// which hands the buffer back at once
+	int receivePackets(IncomingPacket *packets, size_t count) override;
+	// Only after the receiving thread has stopped
+	void closeSocket() override;
+	int getReceiveHandle() const override;
+	void prepareReceive() override;
+	NetworkBackend getBackend() const override;
+
+private:
+	// One io_uring instance mapped into this process, driven through the
+	// raw syscalls. Only the owner of the ring touches it.
+	struct Ring
+	{
+		int fd = -1;
+		unsigned sqEntries = 0;
+
+		bool setup(unsigned entries, io_uring_params &params);
+		void close();
+
+		// Entry `index` past the last queued one, cleared
+		io_uring_sqe& prepare(unsigned index);
+		// Makes the next `count` prepared entries visible to the kernel
+		void queue(unsigned count);
+		int enter(unsigned submit, unsigned wait, unsigned flags,
+				const void *arg = nullptr, size_t argSize = 0);
+
+		const io_uring_cqe* peek() const;
+		void pop();
+
+	private:
+		void *m_ring = nullptr;
+		size_t m_ringSize = 0;
+		void *m_completionRing = nullptr; // Same mapping with SINGLE_MMAP
+		size_t m_completionRingSize = 0;
+		io_uring_sqe *m_entries = nullptr;
+		size_t m_entriesSize = 0;
+
+		unsigned *m_sqTail = nullptr;
+		unsigned m_sqMask = 0;
+		unsigned *m_cqHead = nullptr;
+		unsigned *m_cqTail = nullptr;
+		unsigned m_cqMask = 0;
+		io_uring_cqe *m_completions = nullptr;
+	};
+
+	bool setupRings();
+	void closeRings();
+	bool armReceive();
+	int reapReceived(IncomingPacket *packets, size_t count);
+	void recycleBuffer(uint16_t id);
+
+	// Sends are serialised, the batch's headers live here until completion
+	Ring m_sendRing;
+	std::mutex m_sendMutex;
+	std::vector<msghdr> m_sendHeaders;
+
+	Ring m_receiveRing;
+	int m_eventFd = -1;
+	bool m_receiveEnabled = false; // Receiving thread is the submitter
+	bool m_receiveArmed = false;   // Multishot recvmsg still running
+	int m_receiveError = 0;        // First error since the last reap
+
+	// Provided buffers: datagram i lands in slab buffer `bid` as an
+	// io_uring_recvmsg_out header, sender, control messages and payload
+	msghdr m_receiveHeader
+	{ };
+	io_uring_buf *m_bufferRing = nullptr; // Tail overlays entry 0
+	uint16_t m_bufferTail = 0;
+	size_t m_bufferSize = 0;
+	std::unique_ptr<uint8_t[]> m_buffers;
+
+	std::atomic<NetworkBackend> m_backend
+	{ NetworkBackend::Sockets };
+};
+} // namespace ArtNet
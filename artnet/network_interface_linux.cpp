@@ -1,18 +1,61 @@
 #include "network_interface_linux.h"
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cstring>
 #include <fcntl.h>
 #include <iostream>
+#include <linux/errqueue.h>
+#include <linux/filter.h>
+#include <linux/net_tstamp.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
 #include <unistd.h>
 
 namespace ArtNet
 {
-NetworkInterfaceLinux::NetworkInterfaceLinux() :
-		m_recvBuffer(MAX_PACKET_SIZE)
+
+// Room for the largest timestamp control message of one datagram
+static constexpr size_t RECV_CONTROL_SIZE = CMSG_SPACE(
+		sizeof(scm_timestamping));
+
+static std::chrono::nanoseconds toNanoseconds(const timespec &time)
+{
+	return std::chrono::seconds(time.tv_sec)
+			+ std::chrono::nanoseconds(time.tv_nsec);
+}
+
+static std::chrono::nanoseconds realtimeNow()
+{
+	timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	return toNanoseconds(now);
+}
+
+std::chrono::nanoseconds NetworkInterfaceLinux::receiveTimestamp(
+		msghdr &header)
 {
+	for (cmsghdr *message = CMSG_FIRSTHDR(&header); message; message =
+			CMSG_NXTHDR(&header, message))
+	{
+		if (message->cmsg_level != SOL_SOCKET)
+			continue;
+		if (message->cmsg_type == SCM_TIMESTAMPING)
+		{
+			scm_timestamping stamps;
+			std::memcpy(&stamps, CMSG_DATA(message), sizeof(stamps));
+			return toNanoseconds(stamps.ts[0]);
+		}
+		if (message->cmsg_type == SCM_TIMESTAMPNS)
+		{
+			timespec stamp;
+			std::memcpy(&stamp, CMSG_DATA(message), sizeof(stamp));
+			return toNanoseconds(stamp);
+		}
+	}
+	return std::chrono::nanoseconds(0);
 }
 
 int NetworkInterfaceLinux::getSocket() const
@@ -43,6 +86,14 @@ bool NetworkInterfaceLinux::createSocket(const std::string &bindAddress,
 		return false;
 	}
 
+	if (m_reusePort
+			&& setsockopt(m_socket, SOL_SOCKET, SO_REUSEPORT, &enable,
+					sizeof(int)) < 0)
+	{
+		std::cerr << "ArtNet: Failed to set socket to reuse port" << std::endl;
+		return false;
+	}
+
 	int broadcastEnable = 1;
 	if (setsockopt(m_socket, SOL_SOCKET, SO_BROADCAST, &broadcastEnable,
 			sizeof(broadcastEnable)) < 0)
@@ -102,8 +153,22 @@ bool NetworkInterfaceLinux::bindSocket()
 	return true;
 }
 
-bool NetworkInterfaceLinux::sendPacket(const std::vector<uint8_t> &packet,
-		const std::string &address, int port)
+bool NetworkInterfaceLinux::sendPacket(const iovec *segments, size_t count,
+		const Endpoint &destination)
+{
+	if (m_timestamping != Timestamping::ReceiveAndSend)
+		return sendOne(segments, count, destination);
+
+	std::lock_guard<std::mutex> lock(m_txMutex);
+	std::chrono::nanoseconds submitted = realtimeNow();
+	if (!sendOne(segments, count, destination))
+		return false;
+	recordSubmitted(1, submitted);
+	return true;
+}
+
+bool NetworkInterfaceLinux::sendOne(const iovec *segments, size_t count,
+		const Endpoint &destination)
 {
 	if (m_socket == -1)
 	{
@@ -111,13 +176,15 @@ bool NetworkInterfaceLinux::sendPacket(const std::vector<uint8_t> &packet,
 		return false;
 	}
 
-	sockaddr_in broadcastAddr;
-	broadcastAddr.sin_family = AF_INET;
-	broadcastAddr.sin_port = htons(port);
-	broadcastAddr.sin_addr.s_addr = inet_addr(address.c_str());
+	msghdr header
+	{ };
+	header.msg_name = const_cast<sockaddr_in*>(&destination.address);
+	header.msg_namelen = sizeof(destination.address);
+	header.msg_iov = const_cast<iovec*>(segments);
+	header.msg_iovlen = count;
 
-	ssize_t bytesSent = sendto(m_socket, packet.data(), packet.size(), 0,
-			reinterpret_cast<sockaddr*>(&broadcastAddr), sizeof(broadcastAddr));
+	ssize_t bytesSent = sendmsg(m_socket, &header, 0);
+	m_sendCalls++;
 
 	if (bytesSent == -1)
 	{
@@ -125,35 +192,355 @@ bool NetworkInterfaceLinux::sendPacket(const std::vector<uint8_t> &packet,
 				<< std::endl;
 		return false;
 	}
+	m_packetsSent++;
 	return true;
 }
 
-int NetworkInterfaceLinux::receivePacket(std::vector<uint8_t> &buffer)
+size_t NetworkInterfaceLinux::sendPackets(const OutgoingPacket *packets,
+		size_t count)
+{
+	if (m_socket == -1)
+	{
+		std::cerr << "ArtNet: Socket not initialized" << std::endl;
+		return 0;
+	}
+
+	size_t sent = 0;
+
+	// Numbering of timestamped datagrams must follow the send order
+	bool stamping = m_timestamping == Timestamping::ReceiveAndSend;
+	std::unique_lock<std::mutex> txLock(m_txMutex, std::defer_lock);
+	std::chrono::nanoseconds submitted
+	{ 0 };
+	if (stamping)
+	{
+		txLock.lock();
+		submitted = realtimeNow();
+	}
+
+	if (m_useSendmmsg)
+	{
+		// Scratch space per sending thread, grown to the largest batch it
+		// sent, so a keep-alive can go out while a paced batch is running
+		static thread_local std::vector<mmsghdr> t_sendHeaders;
+		if (t_sendHeaders.size() < count)
+			t_sendHeaders.resize(count);
+
+		// Segments are referenced in place, payloads are never copied
+		for (size_t i = 0; i < count; i++)
+		{
+			msghdr &header = t_sendHeaders[i].msg_hdr;
+			std::memset(&header, 0, sizeof(header));
+			header.msg_name = const_cast<sockaddr_in*>(
+					&packets[i].destination.address);
+			header.msg_namelen = sizeof(sockaddr_in);
+			header.msg_iov = const_cast<iovec*>(packets[i].segments.data());
+			header.msg_iovlen = packets[i].segmentCount;
+		}
+
+		while (sent < count)
+		{
+			// The kernel caps a single call at UIO_MAXIOV messages
+			unsigned int chunk = static_cast<unsigned int>(std::min<size_t>(
+					count - sent, UIO_MAXIOV));
+			int result = sendmmsg(m_socket, &t_sendHeaders[sent], chunk, 0);
+			m_sendCalls++;
+
+			if (result < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				if (errno == ENOSYS)
+				{
+					// Kernel without sendmmsg, use the sendmsg loop from now on
+					m_useSendmmsg = false;
+					break;
+				}
+				std::cerr << "ArtNet: Error sending packet batch: "
+						<< strerror(errno) << std::endl;
+				return sent;
+			}
+			sent += static_cast<size_t>(result);
+			m_packetsSent += static_cast<size_t>(result);
+			if (stamping)
+				recordSubmitted(static_cast<size_t>(result), submitted);
+		}
+	}
+
+	// Fallback: one sendmsg() per packet
+	for (; sent < count; sent++)
+	{
+		const OutgoingPacket &packet = packets[sent];
+		if (!sendOne(packet.segments.data(), packet.segmentCount,
+				packet.destination))
+			break;
+		if (stamping)
+			recordSubmitted(1, submitted);
+	}
+
+	return sent;
+}
+
+int NetworkInterfaceLinux::receivePacket(uint8_t *buffer, size_t capacity,
+		Endpoint &sender)
 {
-	sockaddr_in senderAddr;
-	socklen_t addrLen = sizeof(senderAddr);
+	socklen_t addrLen = sizeof(sender.address);
 
-	ssize_t bytesReceived = recvfrom(m_socket, m_recvBuffer.data(),
-			m_recvBuffer.size(), 0, reinterpret_cast<sockaddr*>(&senderAddr),
-			&addrLen);
+	ssize_t bytesReceived = recvfrom(m_socket, buffer, capacity,
+			m_nonBlockingReceive ? MSG_DONTWAIT : 0,
+			reinterpret_cast<sockaddr*>(&sender.address), &addrLen);
 	if (bytesReceived == -1)
 	{
-		if (errno != EAGAIN && errno != EWOULDBLOCK)
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
 		{
-			std::cerr << "ArtNet (Linux): Error receiving data: "
-					<< strerror(errno) << std::endl;
+			return 0; // Timed out, no data
 		}
-		return 0; // Non-blocking socket returns 0 if no data
+		return -1;
 	}
 
-	buffer.assign(m_recvBuffer.begin(), m_recvBuffer.begin() + bytesReceived);
-	std::cout << "ArtNet (Linux): receivePacket, buffer.size: " << buffer.size()
-			<< std::endl;
-	std::cout << "ArtNet (Linux): bytes received: " << bytesReceived
-			<< std::endl;
 	return static_cast<int>(bytesReceived);
 }
 
+bool NetworkInterfaceLinux::setMaxPacingRate(uint64_t bytesPerSecond)
+{
+	if (m_socket == -1)
+		return false;
+
+	// Enforced by the fq qdisc; other qdiscs accept the option and ignore it
+	uint64_t rate = bytesPerSecond == 0 ? ~uint64_t(0) : bytesPerSecond;
+	if (setsockopt(m_socket, SOL_SOCKET, SO_MAX_PACING_RATE, &rate,
+			sizeof(rate)) == 0)
+		return true;
+
+	// Kernels before 4.20 only take a 32-bit rate
+	uint32_t rate32 = static_cast<uint32_t>(std::min<uint64_t>(rate,
+			~uint32_t(0)));
+	if (setsockopt(m_socket, SOL_SOCKET, SO_MAX_PACING_RATE, &rate32,
+			sizeof(rate32)) == 0)
+		return true;
+
+	std::cerr << "ArtNet: Failed to set pacing rate: " << strerror(errno)
+			<< std::endl;
+	return false;
+}
+
+bool NetworkInterfaceLinux::attachReceiveSharding(size_t workers)
+{
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+	if (m_socket == -1 || workers == 0)
+		return false;
+
+	// Runs on the UDP payload and returns the socket index in the group,
+	// the same choice as receiveShard(). Short datagrams abort with 0.
+	sock_filter code[] =
+	{
+	BPF_STMT(BPF_LD | BPF_H | BPF_ABS, ARTNET_OPCODE_OFFSET),
+	BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0x0050, 1, 0), // OpDmx bytes
+	BPF_STMT(BPF_RET | BPF_K, 0),
+	BPF_STMT(BPF_LD | BPF_B | BPF_ABS, ARTDMX_UNIVERSE_OFFSET + 1), // Net
+	BPF_STMT(BPF_ALU | BPF_LSH | BPF_K, 8),
+	BPF_STMT(BPF_MISC | BPF_TAX, 0),
+	BPF_STMT(BPF_LD | BPF_B | BPF_ABS, ARTDMX_UNIVERSE_OFFSET), // SubUni
+	BPF_STMT(BPF_ALU | BPF_OR | BPF_X, 0),
+	BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, static_cast<uint32_t>(workers)),
+	BPF_STMT(BPF_RET | BPF_A, 0) };
+
+	sock_fprog program
+	{ static_cast<unsigned short>(sizeof(code) / sizeof(code[0])), code };
+	if (setsockopt(m_socket, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program,
+			sizeof(program)) == 0)
+		return true;
+
+	std::cerr << "ArtNet: Failed to attach reuseport filter: "
+			<< strerror(errno) << std::endl;
+#else
+	(void) workers;
+#endif
+	return false;
+}
+
+int NetworkInterfaceLinux::receivePackets(IncomingPacket *packets,
+		size_t count)
+{
+	Timestamping timestamping = m_timestamping;
+	if (timestamping == Timestamping::ReceiveAndSend)
+	{
+		// Pending send timestamps keep the socket reporting an error, on
+		// the recvfrom() fallback too
+		drainSendTimestamps();
+	}
+
+	if (!m_useRecvmmsg)
+		return NetworkInterface::receivePackets(packets, count);
+
+	if (m_recvHeaders.size() < count)
+	{
+		m_recvHeaders.resize(count);
+		m_recvSegments.resize(count);
+		m_recvControl.resize(count * RECV_CONTROL_SIZE);
+	}
+
+	// Datagrams land straight in the caller's slots
+	for (size_t i = 0; i < count; i++)
+	{
+		m_recvSegments[i].iov_base = packets[i].data;
+		m_recvSegments[i].iov_len = packets[i].capacity;
+
+		msghdr &header = m_recvHeaders[i].msg_hdr;
+		std::memset(&header, 0, sizeof(header));
+		header.msg_name = &packets[i].sender.address;
+		header.msg_namelen = sizeof(sockaddr_in);
+		header.msg_iov = &m_recvSegments[i];
+		header.msg_iovlen = 1;
+		if (timestamping != Timestamping::Off)
+		{
+			header.msg_control = &m_recvControl[i * RECV_CONTROL_SIZE];
+			header.msg_controllen = RECV_CONTROL_SIZE;
+		}
+	}
+
+	// Waits for the first datagram (up to SO_RCVTIMEO) unless non-blocking,
+	// then only takes what is already queued
+	unsigned int chunk = static_cast<unsigned int>(std::min<size_t>(count,
+			UIO_MAXIOV));
+	int result = recvmmsg(m_socket, m_recvHeaders.data(), chunk,
+			m_nonBlockingReceive ? MSG_DONTWAIT : MSG_WAITFORONE, nullptr);
+	m_receiveCalls++;
+
+	if (result < 0)
+	{
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+			return 0; // Timed out, no data
+		if (errno == ENOSYS)
+		{
+			// Kernel without recvmmsg, use recvfrom from now on
+			m_useRecvmmsg = false;
+			return NetworkInterface::receivePackets(packets, count);
+		}
+		return -1;
+	}
+
+	for (int i = 0; i < result; i++)
+	{
+		packets[i].size = m_recvHeaders[i].msg_len;
+		packets[i].timestamp =
+				timestamping != Timestamping::Off ?
+						receiveTimestamp(m_recvHeaders[i].msg_hdr) :
+						std::chrono::nanoseconds(0);
+	}
+	recordReceiveBatch(static_cast<size_t>(result));
+	return result;
+}
+
+bool NetworkInterfaceLinux::setKernelTimestamps(bool enable)
+{
+	if (m_socket == -1)
+		return false;
+
+	if (!enable)
+	{
+		int off = 0;
+		setsockopt(m_socket, SOL_SOCKET, SO_TIMESTAMPING, &off, sizeof(off));
+		setsockopt(m_socket, SOL_SOCKET, SO_TIMESTAMPNS, &off, sizeof(off));
+		m_timestamping = Timestamping::Off;
+		return true;
+	}
+
+	// Send timestamps come back on the error queue without the payload,
+	// numbered from 0 on this socket
+	{
+		std::lock_guard<std::mutex> lock(m_txMutex);
+		m_txNext = 0;
+	}
+	int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_TX_SOFTWARE
+			| SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_OPT_ID
+			| SOF_TIMESTAMPING_OPT_TSONLY;
+	if (setsockopt(m_socket, SOL_SOCKET, SO_TIMESTAMPING, &flags,
+			sizeof(flags)) == 0)
+	{
+		m_timestamping = Timestamping::ReceiveAndSend;
+		return true;
+	}
+
+	int on = 1;
+	if (setsockopt(m_socket, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0)
+	{
+		m_timestamping = Timestamping::Receive;
+		return true;
+	}
+
+	std::cerr << "ArtNet: Failed to enable kernel timestamps: "
+			<< strerror(errno) << std::endl;
+	return false;
+}
+
+LatencyHistogram::Snapshot NetworkInterfaceLinux::getSendDelay() const
+{
+	return m_sendDelay.getSnapshot();
+}
+
+void NetworkInterfaceLinux::recordSubmitted(size_t count,
+		std::chrono::nanoseconds submitted)
+{
+	for (size_t i = 0; i < count; i++, m_txNext++)
+	{
+		m_txSubmitted[m_txNext % TX_RING_SIZE] = submitted;
+	}
+}
+
+void NetworkInterfaceLinux::drainSendTimestamps()
+{
+	alignas(cmsghdr) uint8_t control[256];
+	while (true)
+	{
+		msghdr header
+		{ };
+		header.msg_control = control;
+		header.msg_controllen = sizeof(control);
+		if (recvmsg(m_socket, &header, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+			return; // Queue empty
+
+		std::chrono::nanoseconds sent
+		{ 0 };
+		bool numbered = false;
+		uint32_t id = 0;
+		for (cmsghdr *message = CMSG_FIRSTHDR(&header); message; message =
+				CMSG_NXTHDR(&header, message))
+		{
+			if (message->cmsg_level == SOL_SOCKET
+					&& message->cmsg_type == SCM_TIMESTAMPING)
+			{
+				scm_timestamping stamps;
+				std::memcpy(&stamps, CMSG_DATA(message), sizeof(stamps));
+				sent = toNanoseconds(stamps.ts[0]);
+			}
+			else if (message->cmsg_level == SOL_IP
+					&& message->cmsg_type == IP_RECVERR)
+			{
+				sock_extended_err error;
+				std::memcpy(&error, CMSG_DATA(message), sizeof(error));
+				if (error.ee_errno == ENOMSG
+						&& error.ee_origin == SO_EE_ORIGIN_TIMESTAMPING)
+				{
+					id = error.ee_data;
+					numbered = true;
+				}
+			}
+		}
+		if (!numbered || sent.count() == 0)
+			continue;
+
+		// Only datagrams still in the ring can be matched
+		std::lock_guard<std::mutex> lock(m_txMutex);
+		if (m_txNext - id - 1 < TX_RING_SIZE)
+		{
+			m_sendDelay.record(
+					std::max(sent - m_txSubmitted[id % TX_RING_SIZE],
+							std::chrono::nanoseconds(0)));
+		}
+	}
+}
+
 void NetworkInterfaceLinux::closeSocket()
 {
 	if (m_socket != -1)
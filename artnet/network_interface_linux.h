@@ -1,7 +1,11 @@
 #pragma once
 
 #include "ArtNetController.h"
+#include <array>
+#include <chrono>
+#include <mutex>
 #include <string>
+#include <sys/socket.h>
 #include <vector>
 
 namespace ArtNet
@@ -9,21 +13,69 @@ namespace ArtNet
 class NetworkInterfaceLinux: public NetworkInterface
 {
 public:
-	NetworkInterfaceLinux();
+	NetworkInterfaceLinux() = default;
 	~NetworkInterfaceLinux() override = default;
 
 	bool createSocket(const std::string &bindAddress, int port) override;
 	bool bindSocket() override;
-	bool sendPacket(const std::vector<uint8_t> &packet,
-			const std::string &address, int port) override;
-	int receivePacket(std::vector<uint8_t> &buffer) override;
+	using NetworkInterface::sendPacket;
+	bool sendPacket(const iovec *segments, size_t count,
+			const Endpoint &destination) override;
+	size_t sendPackets(const OutgoingPacket *packets, size_t count) override;
+	int receivePacket(uint8_t *buffer, size_t capacity, Endpoint &sender)
+			override;
+	int receivePackets(IncomingPacket *packets, size_t count) override;
 	void closeSocket() override;
 	virtual int getSocket() const override;
+	bool setMaxPacingRate(uint64_t bytesPerSecond) override;
+	bool attachReceiveSharding(size_t workers) override;
+	bool setKernelTimestamps(bool enable) override;
+	LatencyHistogram::Snapshot getSendDelay() const override;
+
+protected:
+	enum class Timestamping
+	{
+		Off, Receive, ReceiveAndSend
+	};
+
+	// Software receive timestamp of a datagram, 0 if it carries none
+	static std::chrono::nanoseconds receiveTimestamp(msghdr &header);
+	Timestamping getTimestamping() const
+	{
+		return m_timestamping;
+	}
+	// Caller holds m_txMutex
+	void recordSubmitted(size_t count, std::chrono::nanoseconds submitted);
+	void drainSendTimestamps();
+
+	// Send timestamps carry the datagram's number on this socket
+	// (SOF_TIMESTAMPING_OPT_ID); submit times wait here until the kernel
+	// reports them. Guarded by m_txMutex, only taken with timestamps on.
+	std::mutex m_txMutex;
 
 private:
+	bool sendOne(const iovec *segments, size_t count,
+			const Endpoint &destination);
+
 	int m_socket = -1;
 	std::string m_bindAddress;
-	int m_port;
-	std::vector<uint8_t> m_recvBuffer;
+	int m_port = 0;
+
+	bool m_useSendmmsg = true;
+
+	// recvmmsg() scratch space, grown to the largest batch requested
+	std::vector<mmsghdr> m_recvHeaders;
+	std::vector<iovec> m_recvSegments;
+	std::vector<uint8_t> m_recvControl; // Timestamp cmsg space per slot
+	bool m_useRecvmmsg = true;
+
+	std::atomic<Timestamping> m_timestamping
+	{ Timestamping::Off };
+
+	static constexpr size_t TX_RING_SIZE = 1024;
+	uint32_t m_txNext = 0;
+	std::array<std::chrono::nanoseconds, TX_RING_SIZE> m_txSubmitted
+	{ };
+	LatencyHistogram m_sendDelay;
 };
 } // namespace ArtNet
@@ -0,0 +1,133 @@
+#include "packet_pacer.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace ArtNet
+{
+
+namespace
+{
+
+constexpr double BUCKET_CAPACITY = NetworkInterface::MAX_PACKET_SIZE;
+
+} // namespace
+
+void PacketPacer::setWindow(std::chrono::nanoseconds window)
+{
+	m_window = window;
+}
+
+void PacketPacer::setByteRate(uint64_t bytesPerSecond)
+{
+	m_byteRate = bytesPerSecond;
+	m_tokens = BUCKET_CAPACITY;
+	m_lastRefill = Clock::now();
+}
+
+bool PacketPacer::isEnabled() const
+{
+	return m_window.count() > 0 || m_byteRate > 0;
+}
+
+size_t PacketPacer::packetSize(const OutgoingPacket &packet)
+{
+	size_t size = 0;
+	for (size_t i = 0; i < packet.segmentCount; i++)
+	{
+		size += packet.segments[i].iov_len;
+	}
+	return size;
+}
+
+void PacketPacer::refill(Clock::time_point now)
+{
+	if (m_byteRate == 0)
+		return;
+
+	std::chrono::duration<double> elapsed = now - m_lastRefill;
+	m_tokens = std::min(BUCKET_CAPACITY,
+			m_tokens + elapsed.count() * static_cast<double>(m_byteRate));
+	m_lastRefill = now;
+}
+
+size_t PacketPacer::send(NetworkInterface &networkInterface,
+		const OutgoingPacket *packets, size_t count)
+{
+	// Packet i is due at start + i * gap, so the last one leaves one gap
+	// before the end of the window
+	Clock::time_point start = Clock::now();
+	std::chrono::nanoseconds gap =
+			count > 1 ? m_window / static_cast<int64_t>(count) :
+					std::chrono::nanoseconds(0);
+	Clock::time_point lastSend = start;
+
+	size_t sent = 0;
+	while (sent < count)
+	{
+		Clock::time_point now = Clock::now();
+		refill(now);
+
+		// Everything that is due and covered by tokens goes out together
+		size_t end = sent;
+		while (end < count && start + gap * static_cast<int64_t>(end) <= now)
+		{
+			if (m_byteRate > 0)
+			{
+				double size = static_cast<double>(packetSize(packets[end]));
+				if (m_tokens < size)
+					break;
+				m_tokens -= size;
+			}
+			end++;
+		}
+
+		if (end == sent)
+		{
+			Clock::time_point due = start
+					+ gap * static_cast<int64_t>(sent);
+			if (m_byteRate > 0)
+			{
+				double missing = static_cast<double>(packetSize(packets[sent]))
+						- m_tokens;
+				if (missing > 0)
+				{
+					due = std::max(due,
+							now + std::chrono::duration_cast<Clock::duration>(
+									std::chrono::duration<double>(missing
+											/ static_cast<double>(m_byteRate))));
+				}
+			}
+			m_waits.fetch_add(1, std::memory_order_relaxed);
+			std::this_thread::sleep_until(due);
+			continue;
+		}
+
+		size_t ready = end - sent;
+		size_t chunk = networkInterface.sendPackets(packets + sent, ready);
+
+		// Only the first packet of a chunk waited, the rest left back to back
+		for (size_t i = 0; i < chunk; i++)
+		{
+			if (sent + i > 0)
+				m_packetGap.record(i == 0 ? now - lastSend :
+						std::chrono::nanoseconds(0));
+		}
+		m_pacedPackets.fetch_add(chunk, std::memory_order_relaxed);
+		lastSend = now;
+		sent += chunk;
+
+		if (chunk < ready)
+			break; // Send error, the interface already reported it
+	}
+
+	return sent;
+}
+
+PacketPacer::Statistics PacketPacer::getStatistics() const
+{
+	return Statistics
+	{ m_packetGap.getSnapshot(), m_pacedPackets.load(), m_waits.load() };
+}
+
+} // namespace ArtNet
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "NetworkInterface.h"
+#include "latency_histogram.h"
+
+namespace ArtNet
+{
+
+// Spreads the packets of one batch over a time window and caps the byte
+// rate with a token bucket, so a frame does not hit the switch as a single
+// burst. Packets that are due together still leave in one sendPackets().
+// Not thread-safe, the caller serializes send() and the setters.
+class PacketPacer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Statistics
+	{
+		LatencyHistogram::Snapshot packetGap; // Between packets of a batch
+		uint64_t pacedPackets;
+		uint64_t waits; // Sleeps for the window or the byte rate
+	};
+
+	// Window a batch is spread over, 0 sends it at once
+	void setWindow(std::chrono::nanoseconds window);
+	// Byte rate limit, 0 means unlimited
+	void setByteRate(uint64_t bytesPerSecond);
+	bool isEnabled() const;
+
+	// Returns the number of packets sent, like NetworkInterface::sendPackets
+	size_t send(NetworkInterface &networkInterface,
+			const OutgoingPacket *packets, size_t count);
+
+	Statistics getStatistics() const;
+
+private:
+	static size_t packetSize(const OutgoingPacket &packet);
+	void refill(Clock::time_point now);
+
+	std::chrono::nanoseconds m_window
+	{ 0 };
+	uint64_t m_byteRate = 0;
+
+	// Token bucket, holds at most one full-size packet of credit
+	double m_tokens = 0;
+	Clock::time_point m_lastRefill;
+
+	LatencyHistogram m_packetGap;
+	std::atomic<uint64_t> m_pacedPackets
+	{ 0 };
+	std::atomic<uint64_t> m_waits
+	{ 0 };
+};
+
+} // namespace ArtNet
@@ -0,0 +1,81 @@
+#include "packet_pool.h"
+#include "logging.h"
+
+#include <algorithm>
+
+namespace ArtNet
+{
+
+void PacketPool::Ref::reset()
+{
+	if (!m_slot)
+		return;
+	if (m_slot->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		m_slot->pool->release(m_slot);
+	}
+	m_slot = nullptr;
+}
+
+bool PacketPool::allocate(size_t slots)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_free.size() != m_capacity)
+	{
+		Logger::error("Packet pool still has ", m_capacity - m_free.size(),
+				" slot(s) in use");
+		return false;
+	}
+
+	m_storage.reset(new uint8_t[slots * SLOT_SIZE]);
+	m_slots.reset(new Slot[slots]);
+	m_capacity = slots;
+	m_free.clear();
+	m_free.reserve(slots);
+	// Hand out the start of the slab first
+	for (size_t i = slots; i > 0; i--)
+	{
+		Slot &slot = m_slots[i - 1];
+		slot.pool = this;
+		slot.data = m_storage.get() + (i - 1) * SLOT_SIZE;
+		m_free.push_back(&slot);
+	}
+	m_minAvailable = slots;
+	m_acquired = 0;
+	m_exhausted = 0;
+	return true;
+}
+
+PacketPool::Ref PacketPool::acquire()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_free.empty())
+	{
+		m_exhausted++;
+		return Ref();
+	}
+
+	Slot *slot = m_free.back();
+	m_free.pop_back();
+	m_acquired++;
+	m_minAvailable = std::min(m_minAvailable, m_free.size());
+
+	slot->size = 0;
+	slot->references.store(1, std::memory_order_relaxed);
+	return Ref(slot);
+}
+
+PacketPool::Statistics PacketPool::getStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return Statistics
+	{ m_capacity, m_free.size(), m_minAvailable, m_acquired, m_exhausted };
+}
+
+void PacketPool::release(Slot *slot)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_free.push_back(slot);
+}
+
+} // namespace ArtNet
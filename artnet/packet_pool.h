@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ArtNet
+{
+
+// Fixed slab of SLOT_SIZE receive buffers. Datagrams are received straight
+// into a slot and handed out as reference-counted Refs, so a consumer can
+// keep a packet or pass it to another thread without copying it. The slot
+// goes back to the pool when the last Ref is released. Refs must not
+// outlive the pool.
+class PacketPool
+{
+	struct Slot;
+
+public:
+	static constexpr size_t SLOT_SIZE = 2048;
+
+	class Ref
+	{
+	public:
+		Ref() = default;
+		~Ref()
+		{
+			reset();
+		}
+
+		Ref(const Ref &other) :
+				m_slot(other.m_slot)
+		{
+			if (m_slot)
+				m_slot->references.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		Ref(Ref &&other) noexcept :
+				m_slot(other.m_slot)
+		{
+			other.m_slot = nullptr;
+		}
+
+		Ref& operator=(Ref other) noexcept
+		{
+			std::swap(m_slot, other.m_slot);
+			return *this;
+		}
+
+		explicit operator bool() const
+		{
+			return m_slot != nullptr;
+		}
+
+		const uint8_t* data() const
+		{
+			return m_slot->data;
+		}
+
+		size_t size() const
+		{
+			return m_slot->size;
+		}
+
+		// Kernel receive time (CLOCK_REALTIME), 0 without kernel timestamps
+		std::chrono::nanoseconds timestamp() const
+		{
+			return m_slot->timestamp;
+		}
+
+		// Time the datagram waited in the socket buffer
+		std::chrono::nanoseconds queueDelay() const
+		{
+			return m_slot->queueDelay;
+		}
+
+		// Drops this reference, the slot is free once all are gone
+		void reset();
+
+		// Only while no other Ref shares the slot
+		bool unique() const
+		{
+			return m_slot
+					&& m_slot->references.load(std::memory_order_acquire) == 1;
+		}
+		uint8_t* mutableData()
+		{
+			return m_slot->data;
+		}
+		void setSize(size_t size)
+		{
+			m_slot->size = size;
+		}
+		void setTimestamp(std::chrono::nanoseconds timestamp,
+				std::chrono::nanoseconds queueDelay)
+		{
+			m_slot->timestamp = timestamp;
+			m_slot->queueDelay = queueDelay;
+		}
+
+	private:
+		friend class PacketPool;
+
+		explicit Ref(Slot *slot) :
+				m_slot(slot)
+		{
+		}
+
+		Slot *m_slot = nullptr;
+	};
+
+	struct Statistics
+	{
+		size_t capacity;
+		size_t available;
+		size_t minAvailable; // Low-water mark since allocate()
+		uint64_t acquired;
+		uint64_t exhausted; // acquire() found no free slot
+	};
+
+	PacketPool() = default;
+	PacketPool(const PacketPool&) = delete;
+	PacketPool& operator=(const PacketPool&) = delete;
+
+	// (Re)creates the slab, fails while any Ref is still held
+	bool allocate(size_t slots);
+
+	// Empty Ref when every slot is in use. Any thread.
+	Ref acquire();
+
+	Statistics getStatistics() const;
+
+private:
+	struct Slot
+	{
+		PacketPool *pool;
+		uint8_t *data;
+		size_t size = 0;
+		std::chrono::nanoseconds timestamp
+		{ 0 };
+		std::chrono::nanoseconds queueDelay
+		{ 0 };
+		std::atomic<uint32_t> references
+		{ 0 };
+	};
+
+	void release(Slot *slot);
+
+	std::unique_ptr<uint8_t[]> m_storage;
+	std::unique_ptr<Slot[]> m_slots;
+	size_t m_capacity = 0;
+
+	mutable std::mutex m_mutex; // Guards the free list and its counters
+	std::vector<Slot*> m_free;
+	size_t m_minAvailable = 0;
+	uint64_t m_acquired = 0;
+	uint64_t m_exhausted = 0;
+};
+
+} // namespace ArtNet
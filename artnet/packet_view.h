@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "artnet_types.h"
+
+namespace ArtNet
+{
+
+// Zero-copy views onto received datagrams. parse() checks once that the
+// datagram holds every field the view reads; the accessors then read the
+// buffer directly, byte by byte, so no alignment or packing is assumed.
+// A view is only valid while its buffer is.
+
+// "Art-Net\0" as one machine word
+constexpr uint64_t ARTNET_ID_WORD =
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		0x4172742D4E657400ULL;
+#else
+		0x0074654E2D747241ULL;
+#endif
+
+// ID and OpCode are present and the ID matches, with one 64-bit compare
+inline bool hasArtNetId(const uint8_t *buffer, size_t size)
+{
+	if (size < ARTNET_OPCODE_OFFSET + 2)
+		return false;
+	uint64_t id;
+	std::memcpy(&id, buffer, sizeof(id));
+	return id == ARTNET_ID_WORD;
+}
+
+// Only after hasArtNetId()
+inline uint16_t readOpcode(const uint8_t *buffer)
+{
+	return static_cast<uint16_t>(buffer[ARTNET_OPCODE_OFFSET]
+			| (buffer[ARTNET_OPCODE_OFFSET + 1] << 8));
+}
+
+class ArtDmxView
+{
+public:
+	static constexpr size_t SEQUENCE_OFFSET = 12;
+	static constexpr size_t PHYSICAL_OFFSET = 13;
+	static constexpr size_t LENGTH_OFFSET = 16; // High byte first
+
+	// Fails unless the header and the declared length fit in `size`
+	bool parse(const uint8_t *buffer, size_t size)
+	{
+		if (size < ARTDMX_HEADER_SIZE)
+			return false;
+		uint16_t length = static_cast<uint16_t>((buffer[LENGTH_OFFSET] << 8)
+				| buffer[LENGTH_OFFSET + 1]);
+		if (length > ARTNET_MAX_DMX_SIZE || length > size - ARTDMX_HEADER_SIZE)
+			return false;
+
+		m_buffer = buffer;
+		m_length = length;
+		return true;
+	}
+
+	uint8_t sequence() const
+	{
+		return m_buffer[SEQUENCE_OFFSET];
+	}
+
+	uint8_t physical() const
+	{
+		return m_buffer[PHYSICAL_OFFSET];
+	}
+
+	// 15-bit Port-Address from SubUni and Net
+	uint16_t portAddress() const
+	{
+		return static_cast<uint16_t>(m_buffer[ARTDMX_UNIVERSE_OFFSET]
+				| ((m_buffer[ARTDMX_UNIVERSE_OFFSET + 1] & 0x7F) << 8));
+	}
+
+	uint16_t length() const
+	{
+		return m_length;
+	}
+
+	const uint8_t* data() const
+	{
+		return m_buffer + ARTDMX_HEADER_SIZE;
+	}
+
+private:
+	const uint8_t *m_buffer = nullptr;
+	uint16_t m_length = 0;
+};
+
+class ArtSyncView
+{
+public:
+	bool parse(const uint8_t *buffer, size_t size)
+	{
+		(void) buffer; // Aux fields carry no information
+		return size >= sizeof(ArtSyncPacket);
+	}
+};
+
+class ArtPollView
+{
+public:
+	static constexpr size_t FLAGS_OFFSET = 12;
+	static constexpr size_t DIAG_PRIORITY_OFFSET = 13;
+	static constexpr size_t MIN_SIZE = 14; // Fields after DiagPriority are optional
+
+	bool parse(const uint8_t *buffer, size_t size)
+	{
+		if (size < MIN_SIZE)
+			return false;
+		m_buffer = buffer;
+		return true;
+	}
+
+	uint8_t flags() const
+	{
+		return m_buffer[FLAGS_OFFSET];
+	}
+
+	uint8_t diagPriority() const
+	{
+		return m_buffer[DIAG_PRIORITY_OFFSET];
+	}
+
+private:
+	const uint8_t *m_buffer = nullptr;
+};
+
+class ArtPollReplyView
+{
+public:
+	static constexpr size_t MIN_SIZE = 207; // Up to and including 'MAC Lo'
+
+	bool parse(const uint8_t *buffer, size_t size)
+	{
+		if (size < MIN_SIZE)
+			return false;
+		m_buffer = buffer;
+		m_size = size;
+		return true;
+	}
+
+	// Fills a constructed reply; fields the sender left out stay zero
+	void copyTo(ArtPollReplyPacket &reply) const
+	{
+		std::memcpy(&reply, m_buffer,
+				m_size < sizeof(reply) ? m_size : sizeof(reply));
+	}
+
+private:
+	const uint8_t *m_buffer = nullptr;
+	size_t m_size = 0;
+};
+
+} // namespace ArtNet
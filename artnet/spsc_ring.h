@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "artnet_types.h"
+
+namespace ArtNet
+{
+
+// Bounded lock-free queue from one producer thread to one consumer thread.
+// Slots are allocated once by the constructor and written in place, so
+// pushing and popping never allocate or copy more than the caller does.
+template<typename T>
+class SpscRing
+{
+public:
+	// Capacity is rounded up to a power of two
+	explicit SpscRing(size_t capacity)
+	{
+		size_t size = 1;
+		while (size < capacity)
+			size <<= 1;
+		m_slots.resize(size);
+		m_mask = size - 1;
+	}
+
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	// Producer side: free slot to fill before commit(), nullptr when full
+	T* prepare()
+	{
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_cachedHead > m_mask)
+		{
+			m_cachedHead = m_head.load(std::memory_order_acquire);
+			if (tail - m_cachedHead > m_mask)
+				return nullptr;
+		}
+		return &m_slots[tail & m_mask];
+	}
+
+	// Producer side: hands the prepared slot to the consumer
+	void commit()
+	{
+		m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+				std::memory_order_release);
+	}
+
+	// Consumer side: oldest slot, nullptr when empty
+	const T* front()
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_cachedTail)
+		{
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+			if (head == m_cachedTail)
+				return nullptr;
+		}
+		return &m_slots[head & m_mask];
+	}
+
+	// Consumer side: releases the slot returned by front()
+	void pop()
+	{
+		m_head.store(m_head.load(std::memory_order_relaxed) + 1,
+				std::memory_order_release);
+	}
+
+	// Any thread, approximate while both sides are busy
+	size_t size() const
+	{
+		return m_tail.load(std::memory_order_acquire)
+				- m_head.load(std::memory_order_acquire);
+	}
+
+	size_t capacity() const
+	{
+		return m_mask + 1;
+	}
+
+private:
+	std::vector<T> m_slots;
+	size_t m_mask = 0;
+
+	// Each side owns its index and a stale copy of the other's
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail
+	{ 0 };
+	size_t m_cachedHead = 0; // Producer only
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head
+	{ 0 };
+	size_t m_cachedTail = 0; // Consumer only
+};
+
+} // namespace ArtNet
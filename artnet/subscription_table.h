@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "artnet_types.h"
+
+namespace ArtNet
+{
+
+// Set of subscribed 15-bit Port-Addresses with one slot each. Membership is a
+// bit test in a 32768-bit bitmap and the slot is found through a dense index,
+// so the receive path never searches. Slots are packed in a dense list;
+// removing one moves the last slot into its place.
+// T must be constructible from its Port-Address.
+// Not thread-safe, the owner is responsible for locking.
+template<typename T>
+class SubscriptionTable
+{
+public:
+	SubscriptionTable() :
+			m_slotIndex(ARTNET_PORT_ADDRESS_COUNT, NO_SLOT)
+	{
+		m_bits.fill(0);
+	}
+
+	bool contains(uint16_t portAddress) const
+	{
+		return portAddress < ARTNET_PORT_ADDRESS_COUNT
+				&& ((m_bits[portAddress / 64] >> (portAddress % 64)) & 1) != 0;
+	}
+
+	// Slot of a Port-Address that contains() returned true for
+	T& at(uint16_t portAddress) const
+	{
+		return *m_slots[m_slotIndex[portAddress]];
+	}
+
+	// Returns the slot or nullptr if the Port-Address is not subscribed
+	T* find(uint16_t portAddress) const
+	{
+		return contains(portAddress) ? &at(portAddress) : nullptr;
+	}
+
+	// Returns the slot for the Port-Address, adding it if needed
+	T& add(uint16_t portAddress)
+	{
+		if (contains(portAddress))
+			return at(portAddress);
+
+		m_slotIndex[portAddress] = static_cast<uint16_t>(m_slots.size());
+		m_slots.push_back(std::make_unique<T>(portAddress));
+		m_addresses.push_back(portAddress);
+		m_bits[portAddress / 64] |= uint64_t(1) << (portAddress % 64);
+		return *m_slots.back();
+	}
+
+	bool remove(uint16_t portAddress)
+	{
+		if (!contains(portAddress))
+			return false;
+
+		uint16_t slot = m_slotIndex[portAddress];
+		uint16_t last = static_cast<uint16_t>(m_slots.size() - 1);
+		if (slot != last)
+		{
+			m_slots[slot] = std::move(m_slots[last]);
+			m_addresses[slot] = m_addresses[last];
+			m_slotIndex[m_addresses[slot]] = slot;
+		}
+		m_slots.pop_back();
+		m_addresses.pop_back();
+		m_slotIndex[portAddress] = NO_SLOT;
+		m_bits[portAddress / 64] &= ~(uint64_t(1) << (portAddress % 64));
+		return true;
+	}
+
+	// Subscribed Port-Addresses, in slot order
+	const std::vector<uint16_t>& addresses() const
+	{
+		return m_addresses;
+	}
+
+	size_t size() const
+	{
+		return m_slots.size();
+	}
+
+	void clear()
+	{
+		for (uint16_t portAddress : m_addresses)
+		{
+			m_slotIndex[portAddress] = NO_SLOT;
+		}
+		m_bits.fill(0);
+		m_slots.clear();
+		m_addresses.clear();
+	}
+
+private:
+	static constexpr uint16_t NO_SLOT = 0xFFFF;
+
+	std::array<uint64_t, ARTNET_PORT_ADDRESS_COUNT / 64> m_bits;
+	std::vector<uint16_t> m_slotIndex; // Port-Address -> slot
+	std::vector<std::unique_ptr<T>> m_slots;
+	std::vector<uint16_t> m_addresses; // Slot -> Port-Address
+};
+
+} // namespace ArtNet
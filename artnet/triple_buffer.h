@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "artnet_types.h"
+
+namespace ArtNet
+{
+
+// Lock-free handoff of the latest value from one producer thread to one
+// consumer thread. The producer always has a private back buffer to write
+// into and never waits; the consumer always reads the newest published value.
+// Values the consumer did not pick up in time are overwritten, not queued.
+template<typename T>
+class TripleBuffer
+{
+public:
+	// Producer side: buffer to fill before publish()
+	T& writeBuffer()
+	{
+		return m_buffers[m_back].value;
+	}
+
+	// Producer side: makes the write buffer the newest value. Returns false
+	// if the previous value was replaced before the consumer took it.
+	bool publish()
+	{
+		uint8_t previous = m_shared.exchange(
+				static_cast<uint8_t>(m_back | FRESH_BIT),
+				std::memory_order_acq_rel);
+		m_back = previous & INDEX_MASK;
+		return (previous & FRESH_BIT) == 0;
+	}
+
+	// Consumer side: switches to the newest value if one was published since
+	// the last call. Returns true when readBuffer() changed.
+	bool update()
+	{
+		if ((m_shared.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+			return false;
+
+		uint8_t previous = m_shared.exchange(m_front,
+				std::memory_order_acq_rel);
+		m_front = previous & INDEX_MASK;
+		return true;
+	}
+
+	// Consumer side: value selected by the last update()
+	const T& readBuffer() const
+	{
+		return m_buffers[m_front].value;
+	}
+
+	// True while a published value waits for the consumer
+	bool pending() const
+	{
+		return (m_shared.load(std::memory_order_relaxed) & FRESH_BIT) != 0;
+	}
+
+private:
+	static constexpr uint8_t INDEX_MASK = 0x03;
+	static constexpr uint8_t FRESH_BIT = 0x04;
+
+	// Keep producer and consumer buffers on separate cache lines
+	struct alignas(CACHE_LINE_SIZE) Slot
+	{
+		T value
+		{ };
+	};
+
+	std::array<Slot, 3> m_buffers;
+	alignas(CACHE_LINE_SIZE) std::atomic<uint8_t> m_shared
+	{ 1 };
+	alignas(CACHE_LINE_SIZE) uint8_t m_back = 0; // Producer only
+	alignas(CACHE_LINE_SIZE) uint8_t m_front = 2; // Consumer only
+};
+
+} // namespace ArtNet
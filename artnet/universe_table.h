@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "artnet_types.h"
+
+namespace ArtNet
+{
+
+// Sparse table indexed by the 15-bit Port-Address. Slots are allocated lazily
+// the first time a universe is touched and are kept in a dense list of active
+// Port-Addresses so callers can iterate only the universes in use.
+// T must be constructible from its Port-Address.
+// Not thread-safe, the owner is responsible for locking.
+template<typename T>
+class UniverseTable
+{
+public:
+	UniverseTable() :
+			m_slots(ARTNET_PORT_ADDRESS_COUNT)
+	{
+	}
+
+	// Returns the slot for the Port-Address or nullptr if it was never used
+	T* find(uint16_t portAddress) const
+	{
+		if (portAddress >= ARTNET_PORT_ADDRESS_COUNT)
+			return nullptr;
+		return m_slots[portAddress].get();
+	}
+
+	// Returns the slot for the Port-Address, allocating it on first use
+	T& acquire(uint16_t portAddress)
+	{
+		std::unique_ptr<T> &slot = m_slots[portAddress];
+		if (!slot)
+		{
+			slot = std::make_unique<T>(portAddress);
+			m_active.push_back(portAddress);
+		}
+		return *slot;
+	}
+
+	// Port-Addresses with an allocated slot, in order of first use
+	const std::vector<uint16_t>& active() const
+	{
+		return m_active;
+	}
+
+	size_t size() const
+	{
+		return m_active.size();
+	}
+
+	void clear()
+	{
+		for (uint16_t portAddress : m_active)
+		{
+			m_slots[portAddress].reset();
+		}
+		m_active.clear();
+	}
+
+private:
+	std::vector<std::unique_ptr<T>> m_slots;
+	std::vector<uint16_t> m_active;
+};
+
+} // namespace ArtNet
@@ -2,15 +2,76 @@
 #include "logging.h"
 
 #include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <ifaddrs.h>
 #include <iostream>
 #include <netinet/in.h>
 #include <sstream>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace ArtNet
 {
 namespace utils
 {
 
+size_t usedLength(const uint8_t *data, size_t length)
+{
+	// Skip the zero tail a word at a time, then find the last set byte
+	while (length >= sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, data + length - sizeof(word), sizeof(word));
+		if (word != 0)
+			break;
+		length -= sizeof(word);
+	}
+	while (length > 0 && data[length - 1] == 0)
+	{
+		length--;
+	}
+	return length;
+}
+
+void maxBytes(uint8_t *dst, const uint8_t *src, size_t length)
+{
+	size_t i = 0;
+#if defined(__SSE2__)
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+				_mm_max_epu8(a, b));
+	}
+#elif defined(__ARM_NEON)
+	for (; i + 16 <= length; i += 16)
+	{
+		vst1q_u8(dst + i, vmaxq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+	}
+#endif
+	for (; i < length; i++)
+	{
+		if (src[i] > dst[i])
+			dst[i] = src[i];
+	}
+}
+
+void copyChanged(uint8_t *dst, const uint8_t *previous, const uint8_t *next,
+		size_t length)
+{
+	// Branch-free so the compiler can vectorize it
+	for (size_t i = 0; i < length; i++)
+	{
+		dst[i] = next[i] != previous[i] ? next[i] : dst[i];
+	}
+}
+
 std::string formatIP(const std::array<uint8_t, 4> &ip)
 {
 	std::stringstream ss;
@@ -65,5 +126,26 @@ std::string ipAddressToString(sockaddr_in ip)
 	return inet_ntop(AF_INET, &(ip.sin_addr), str, INET_ADDRSTRLEN);
 }
 
+std::vector<uint32_t> localIPv4Addresses()
+{
+	std::vector<uint32_t> addresses;
+	ifaddrs *interfaces = nullptr;
+	if (getifaddrs(&interfaces) == -1)
+	{
+		Logger::error("getifaddrs failed: ", strerror(errno));
+		return addresses;
+	}
+
+	for (ifaddrs *entry = interfaces; entry; entry = entry->ifa_next)
+	{
+		if (!entry->ifa_addr || entry->ifa_addr->sa_family != AF_INET)
+			continue;
+		addresses.push_back(reinterpret_cast<const sockaddr_in*>(
+				entry->ifa_addr)->sin_addr.s_addr);
+	}
+	freeifaddrs(interfaces);
+	return addresses;
+}
+
 } // namespace utils
 } // namespace ArtNet
@@ -6,6 +6,7 @@
 #include <pthread.h>
 #include <sched.h>
 #include <string>
+#include <vector>
 
 namespace ArtNet
 {
@@ -56,11 +57,23 @@ inline bool setThreadPriority(ThreadPriority priority)
 	return true;
 }
 
+// DMX
+// Number of channels up to and including the last non-zero one
+size_t usedLength(const uint8_t *data, size_t length);
+// dst[i] = max(dst[i], src[i]), 16 bytes at a time where SIMD is available
+void maxBytes(uint8_t *dst, const uint8_t *src, size_t length);
+// dst[i] = next[i] wherever next[i] differs from previous[i]
+void copyChanged(uint8_t *dst, const uint8_t *previous, const uint8_t *next,
+		size_t length);
+
 // Networking
 std::string formatIP(const std::array<uint8_t, 4> &ip);
 std::string formatIP(const uint8_t *data, size_t size);
 std::array<uint8_t, 4> parseIP(std::string const &ipString); // added const &
 std::string ipAddressToString(sockaddr_in ip);
+// IPv4 addresses of this host's interfaces (network byte order), loopback
+// included. Empty if they cannot be listed.
+std::vector<uint32_t> localIPv4Addresses();
 
 } // namespace utils
 } // namespace ArtNet